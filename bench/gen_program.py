@@ -0,0 +1,151 @@
+#!/usr/bin/env python3
+"""Writes a synthetic sailfish program of a chosen size, for finding where
+sailfishc's compile time grows faster than its input. The program is main.fish
+in the output directory, importing U0.fish ... by absolute path, so it
+compiles from any directory:
+    ../bench/gen_program.py --functions 200 --imports 8 --output gen
+    ./sailfishc gen/main.fish
+Every function declares and assigns ints, strings and a list literal, then
+nests Trees the given depth deep, each branch holding another block of
+statements, and calls the function before it. Each UDT has an attribute and
+a method, and start creates one of each and calls it.
+"""
+import argparse
+import os
+import sys
+
+
+class Block:
+    """Writes the statements of one function, naming every variable apart so
+    that nested blocks never redeclare one from an enclosing block."""
+
+    def __init__(self, args):
+        self.args = args
+        self.count = 0
+        self.lines = []
+
+    def name(self, prefix):
+        self.count += 1
+        return "%s%d" % (prefix, self.count)
+
+    def emit(self, indent, text):
+        self.lines.append("    " * indent + text)
+
+    def statements(self, indent, depth):
+        """Writes one block of statements, then a Tree holding the next level
+        down, returning the block's first int variable."""
+        first = self.name("v")
+        self.emit(indent, "dec int %s = a + %d * 3" % (first, self.count))
+        for i in range(1, self.args.statements):
+            kind = i % 4
+            if kind == 1:
+                self.emit(indent, "%s = %s %% 7 + a" % (first, first))
+            elif kind == 2 and self.args.list > 0:
+                values = ", ".join(str((j * 75) % 1009)
+                                   for j in range(self.args.list))
+                self.emit(indent, "dec [int] %s = [%s]" %
+                          (self.name("l"), values))
+            elif kind == 3:
+                self.emit(indent, "dec str %s = \"s%d\"" %
+                          (self.name("s"), self.count))
+            else:
+                self.emit(indent, "dec int %s = %s * 2 - %d" %
+                          (self.name("v"), first, i))
+
+        if depth > 1:
+            self.emit(indent, "Tree (")
+            self.emit(indent + 1, "( | %s > %d | {" % (first, depth))
+            inner = self.statements(indent + 2, depth - 1)
+            self.emit(indent + 2, "%s = %s + %s" % (first, first, inner))
+            self.emit(indent + 1, "})")
+            self.emit(indent, ")")
+        return first
+
+
+def function(args, index):
+    block = Block(args)
+    block.emit(0, "(fun f%d(int a)(int) {" % index)
+    first = block.statements(1, args.depth)
+    if index > 0:
+        block.emit(1, "%s = %s + f%d(a - 1)" % (first, first, index - 1))
+    block.emit(1, "return %s" % first)
+    block.emit(0, "})")
+    return "\n".join(block.lines) + "\n"
+
+
+def udt(index):
+    # methods become C functions of the same name, so each UDT's is its own
+    return ("Uat {\n"
+            "    int v\n"
+            "}\n"
+            "\n"
+            "Ufn {\n"
+            "    (fun get%d(int x)(int) {\n"
+            "        return own.v + x * %d\n"
+            "    })\n"
+            "}\n" % (index, index + 1))
+
+
+def generate(args):
+    """Writes the program to args.output, returning the path of main.fish."""
+    output = os.path.abspath(args.output)
+    os.makedirs(output, exist_ok=True)
+
+    parts = []
+    for i in range(args.imports):
+        path = os.path.join(output, "U%d.fish" % i)
+        with open(path, "w") as f:
+            f.write(udt(i))
+        parts.append("import U%d : \"%s\"\n" % (i, path))
+    if parts:
+        parts.append("\n")
+
+    for i in range(args.functions):
+        parts.append(function(args, i) + "\n")
+
+    parts.append("start {\n")
+    for i in range(args.imports):
+        parts.append("    dec U%d u%d = new U%d { v: %d }\n" % (i, i, i, i))
+        parts.append("    printInt(u%d...get%d(%d))\n" % (i, i, i))
+    if args.functions > 0:
+        parts.append("    printInt(f%d(3))\n" % (args.functions - 1))
+    parts.append("}\n")
+
+    main = os.path.join(output, "main.fish")
+    with open(main, "w") as f:
+        f.write("".join(parts))
+    return main
+
+
+def add_size_arguments(parser):
+    """The size of the program, shared with run_scaling.py."""
+    parser.add_argument("--functions", type=int, default=10,
+                        help="number of functions (default 10)")
+    parser.add_argument("--imports", type=int, default=0,
+                        help="number of UDT files imported (default 0)")
+    parser.add_argument("--statements", type=int, default=8,
+                        help="statements in each block (default 8)")
+    parser.add_argument("--depth", type=int, default=1,
+                        help="blocks nested in each function (default 1)")
+    parser.add_argument("--list", type=int, default=4,
+                        help="elements in each list literal (default 4)")
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description="Write a synthetic sailfish program.")
+    add_size_arguments(parser)
+    parser.add_argument("--output", default="gen",
+                        help="directory to write main.fish to (default gen)")
+    args = parser.parse_args()
+
+    if min(args.functions, args.imports, args.list) < 0 or \
+            min(args.statements, args.depth) < 1:
+        parser.error("sizes must not be negative, nor statements and depth "
+                     "less than 1")
+    print(generate(args))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
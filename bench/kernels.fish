@@ -0,0 +1,26 @@
+# Same work as kernels_recursive.fish, done by the runtime's list kernels.
+
+(fun fill([int] a, int i, int n)([int]) {
+    Tree (
+        ( | i < n | { return fill(pushListInt(a, i, i % 10), i + 1, n) })
+    )
+    return a
+})
+
+(fun run([int] a, int rounds, int total)(int) {
+    Tree (
+        ( | rounds > 0 | {
+            a = scaleListInt(a, 1)
+            dec int s = sumListInt(a)
+            dec int d = dotListInt(a, a)
+            return run(a, rounds - 1, total + s + d)
+        })
+    )
+    return total
+})
+
+start {
+    dec [int] a = [0]
+    a = fill(a, 1, 100000)
+    printInt(run(a, 200, 0))
+}
@@ -0,0 +1,60 @@
+# Sums, dot products and scales a list the way sailfish code did before the
+# list kernels existed: one getAtIndexInt call per element, by recursion.
+# Compare with kernels.fish, see run_kernels.sh.
+
+(fun fill([int] a, int i, int n)([int]) {
+    Tree (
+        ( | i < n | { return fill(pushListInt(a, i, i % 10), i + 1, n) })
+    )
+    return a
+})
+
+(fun sum([int] a, int i, int n)(int) {
+    Tree (
+        ( | i < n | {
+            dec int x = getAtIndexInt(a, i)
+            return x + sum(a, i + 1, n)
+        })
+    )
+    return 0
+})
+
+(fun dot([int] a, [int] b, int i, int n)(int) {
+    Tree (
+        ( | i < n | {
+            dec int x = getAtIndexInt(a, i)
+            dec int y = getAtIndexInt(b, i)
+            return x * y + dot(a, b, i + 1, n)
+        })
+    )
+    return 0
+})
+
+(fun scale([int] a, int k, int i, int n)([int]) {
+    Tree (
+        ( | i < n | {
+            dec int x = getAtIndexInt(a, i)
+            a = setAtIndexInt(a, i, x * k)
+            return scale(a, k, i + 1, n)
+        })
+    )
+    return a
+})
+
+(fun run([int] a, int rounds, int total)(int) {
+    Tree (
+        ( | rounds > 0 | {
+            a = scale(a, 1, 0, 100000)
+            dec int s = sum(a, 0, 100000)
+            dec int d = dot(a, a, 0, 100000)
+            return run(a, rounds - 1, total + s + d)
+        })
+    )
+    return total
+})
+
+start {
+    dec [int] a = [0]
+    a = fill(a, 1, 100000)
+    printInt(run(a, 200, 0))
+}
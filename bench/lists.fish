@@ -0,0 +1,42 @@
+# Builds int lists one push at a time, edits every element, joins them and
+# cuts them back down: the list building the other benchmarks only do in
+# passing.
+
+(fun build([int] a, int i, int n)([int]) {
+    Tree (
+        ( | i < n | { return build(pushListInt(a, len(a), i * 75 % 1009), i + 1, n) })
+    )
+    return a
+})
+
+(fun bump([int] a, int i, int n)([int]) {
+    Tree (
+        ( | i < n | {
+            dec int x = getAtIndexInt(a, i)
+            a = setAtIndexInt(a, i, x + i % 7)
+            return bump(a, i + 1, n)
+        })
+    )
+    return a
+})
+
+(fun rounds([int] all, int r)([int]) {
+    Tree (
+        ( | r > 0 | {
+            dec [int] a = [0]
+            a = build(a, 1, 20000)
+            a = bump(a, 0, len(a))
+            all = extendListInt(all, a, len(all), len(a))
+            all = removeRangeInt(all, len(all), 0, 15000)
+            return rounds(all, r - 1)
+        })
+    )
+    return all
+})
+
+start {
+    dec [int] all = [0]
+    all = rounds(all, 200)
+    printInt(len(all))
+    printInt(sumListInt(all))
+}
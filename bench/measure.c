@@ -0,0 +1,53 @@
+/*
+ * Robert Durst 2019
+ * Sailfish Programming Language
+ *
+ * Runs a program and writes its wall time in milliseconds, peak resident
+ * memory in kilobytes and exit status, negated for a signal, to a file, for
+ * run_bench.py. A forked child starts out as big as its parent, so a program
+ * started straight from Python would be charged for Python's memory too.
+ */
+#include <stdio.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+int
+main(int argc, char** argv)
+{
+    struct timespec start, end;
+    struct rusage usage;
+    int status;
+    pid_t pid;
+    FILE* result;
+
+    if (argc < 3)
+    {
+        fprintf(stderr, "usage: %s result-file program [argument ...]\n",
+                argv[0]);
+        return 2;
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    pid = fork();
+    if (pid == 0)
+    {
+        execv(argv[2], argv + 2);
+        _exit(127);
+    }
+    if (pid < 0 || wait4(pid, &status, 0, &usage) < 0)
+        return 2;
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    result = fopen(argv[1], "w");
+    if (result == NULL)
+        return 2;
+    fprintf(result, "%.3f %ld %d\n",
+            (end.tv_sec - start.tv_sec) * 1e3 +
+                (end.tv_nsec - start.tv_nsec) / 1e6,
+            usage.ru_maxrss,
+            WIFSIGNALED(status) ? -WTERMSIG(status) : WEXITSTATUS(status));
+    fclose(result);
+    return 0;
+}
@@ -0,0 +1,46 @@
+import treenode : "../examples/treenode.fish"
+
+# tree.fish again, but each tree is deleted node by node so the next one is
+# built from the same pooled instances. See run_alloc.sh.
+
+(fun build(treenode root, int x, int n)(treenode) {
+    Tree (
+        ( | n > 0 | {
+            dec treenode tn = new treenode { data: x, left: empty, right: empty }
+            root...addNode(tn)
+            return build(root, x * 75 % 65537, n - 1)
+        })
+    )
+    return root
+})
+
+(fun deleteTree(treenode root)(void) {
+    Tree (
+        ( | root...hasLeft(void) | {
+            dec treenode left = root.left
+            deleteTree(left)
+        })
+    )
+    Tree (
+        ( | root...hasRight(void) | {
+            dec treenode right = root.right
+            deleteTree(right)
+        })
+    )
+    delete root
+})
+
+(fun rounds(int r)(void) {
+    Tree (
+        ( | r > 0 | {
+            dec treenode root = new treenode { data: 32768, left: empty, right: empty }
+            root = build(root, 1, 2000)
+            deleteTree(root)
+            rounds(r - 1)
+        })
+    )
+})
+
+start {
+    rounds(100)
+}
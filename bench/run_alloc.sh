@@ -0,0 +1,21 @@
+#!/bin/bash
+# Compiles the allocation heavy programs with malloc and with --arena and
+# prints their allocation counts and running time. Run from the build
+# directory:
+#     ../bench/run_alloc.sh
+SAILFISHC=${SAILFISHC:-./sailfishc}
+BENCH=$(dirname "$0")
+
+for program in tree pool sort_mergesort; do
+    for mode in malloc arena; do
+        flags=""
+        if [ $mode == arena ]; then
+            flags="--arena"
+        fi
+        $SAILFISHC $flags "$BENCH/$program.fish" > /dev/null || exit 1
+        gcc out.c -o "$program" || exit 1
+
+        echo "$program.fish, $mode:"
+        time SAILFISH_ALLOC_STATS=1 ./$program > /dev/null
+    done
+done
@@ -0,0 +1,226 @@
+#!/usr/bin/env python3
+"""Compiles every program in bench/ with sailfishc and gcc, runs it several
+times through measure.c and records how long sailfishc and gcc took, how long
+the program ran and its peak resident memory, writing them to a JSON results
+file. Given a baseline, a results file saved from an earlier run, it prints
+what changed and exits with 1 if anything got slower or bigger by more than
+the threshold. sailfishc runs in bench/, where the programs' ../examples
+imports resolve, and everything else goes in the current directory, such as
+the build directory:
+    ../bench/run_bench.py [--baseline old.json] [program ...]
+or build the bench target.
+"""
+import argparse
+import hashlib
+import json
+import os
+import shlex
+import statistics
+import subprocess
+import sys
+import time
+
+BENCH = os.path.dirname(os.path.abspath(__file__))
+
+# compared against the baseline; for all of them bigger is worse
+METRICS = ["compile_ms", "gcc_ms", "run_ms", "peak_rss_kb"]
+
+
+def measure(args, command, stdout=subprocess.DEVNULL):
+    """Runs command through measure.c, returning its exit status, wall time in
+    milliseconds and peak resident memory in kilobytes."""
+    helper = "./bench-measure"
+    if not os.path.exists(helper):
+        subprocess.run([args.cc, "-O2", os.path.join(BENCH, "measure.c"),
+                        "-o", helper], check=True)
+
+    subprocess.run([helper, "bench-measure.txt"] + command, stdout=stdout,
+                   stderr=subprocess.DEVNULL, check=True)
+    with open("bench-measure.txt") as f:
+        wall, rss, status = f.read().split()
+    os.remove("bench-measure.txt")
+    return int(status), float(wall), int(rss)
+
+
+def sha1(path):
+    """Hashes a file a block at a time, so that memory stays bounded however
+    much a program prints."""
+    digest = hashlib.sha1()
+    with open(path, "rb") as f:
+        for block in iter(lambda: f.read(1 << 16), b""):
+            digest.update(block)
+    return digest.hexdigest()
+
+
+def compile_program(args, name):
+    """Compiles bench/name.fish to bench-name, returning how long sailfishc
+    and gcc took, or None if either failed."""
+    # imports are resolved from the directory sailfishc runs in, which is
+    # also where it writes out.c
+    source = os.path.join(BENCH, name + ".fish")
+    start = time.perf_counter()
+    sailfishc = subprocess.run([os.path.abspath(args.sailfishc)] +
+                               shlex.split(args.flags) + [source],
+                               cwd=BENCH, capture_output=True, text=True)
+    compile_ms = (time.perf_counter() - start) * 1000
+    if os.path.exists(os.path.join(BENCH, "out.c")):
+        os.replace(os.path.join(BENCH, "out.c"), "out.c")
+    if "Successfully wrote compiled code" not in sailfishc.stdout:
+        print(sailfishc.stdout, file=sys.stderr)
+        return None
+
+    start = time.perf_counter()
+    gcc = subprocess.run([args.cc, "out.c", "-o", "bench-" + name, "-lm"] +
+                         shlex.split(args.cflags))
+    gcc_ms = (time.perf_counter() - start) * 1000
+    if gcc.returncode != 0:
+        return None
+    return compile_ms, gcc_ms
+
+
+def run_benchmark(args, name):
+    """Compiles and runs one program args.runs times, after a warm up run,
+    returning its results or None if it failed."""
+    compiles = []
+    for _ in range(args.runs):
+        times = compile_program(args, name)
+        if times is None:
+            return None
+        compiles.append(times)
+
+    runs = []
+    peak = 0
+    digest = None
+    for i in range(args.runs + 1):
+        with open("bench-" + name + ".out", "wb") as out:
+            status, wall, rss = measure(args, ["./bench-" + name], out)
+
+        # generated programs exit with 1, so only a signal is a failure
+        if status < 0:
+            print("bench-%s was killed by signal %d" % (name, -status),
+                  file=sys.stderr)
+            return None
+
+        output = sha1("bench-" + name + ".out")
+        if digest is not None and output != digest:
+            print("bench-%s printed something different on run %d" %
+                  (name, i), file=sys.stderr)
+            return None
+        digest = output
+
+        if i > 0:
+            runs.append(wall)
+            peak = max(peak, rss)
+    os.remove("bench-" + name + ".out")
+
+    # times to the microsecond
+    return {
+        "compile_ms": round(statistics.median(c[0] for c in compiles), 3),
+        "gcc_ms": round(statistics.median(c[1] for c in compiles), 3),
+        "run_ms": round(statistics.median(runs), 3),
+        "run_ms_min": min(runs),
+        "run_ms_max": max(runs),
+        "peak_rss_kb": peak,
+        "output_sha1": digest,
+    }
+
+
+def compare(baseline, results, threshold, everything):
+    """Prints each metric against the baseline, returning whether any got
+    worse by more than threshold percent. Programs the baseline has are
+    missing only if every program was run."""
+    regressed = False
+    print("\n%-20s %-12s %12s %12s %9s" %
+          ("benchmark", "metric", "baseline", "current", "change"))
+    for name, current in sorted(results["benchmarks"].items()):
+        old = baseline["benchmarks"].get(name)
+        if old is None:
+            print("%-20s new" % name)
+            continue
+
+        for metric in METRICS:
+            if metric not in old or old[metric] <= 0:
+                continue
+            change = 100 * (current[metric] - old[metric]) / old[metric]
+            flag = ""
+            if change > threshold:
+                flag = "  worse"
+                regressed = True
+            elif change < -threshold:
+                flag = "  better"
+            print("%-20s %-12s %12.1f %12.1f %+8.1f%%%s" %
+                  (name, metric, old[metric], current[metric], change, flag))
+
+        if old.get("output_sha1") != current["output_sha1"]:
+            print("%-20s output changed" % name)
+            regressed = True
+
+    if everything:
+        for name in sorted(set(baseline["benchmarks"]) -
+                           set(results["benchmarks"])):
+            print("%-20s missing" % name)
+    return regressed
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description="Benchmark the sailfish programs in bench/.")
+    parser.add_argument("programs", nargs="*",
+                        help="names of the programs to run, all by default")
+    parser.add_argument("--sailfishc", default="./sailfishc")
+    parser.add_argument("--flags", default="",
+                        help="options passed to sailfishc, such as --inline")
+    parser.add_argument("--cc", default="gcc")
+    parser.add_argument("--cflags", default="",
+                        help="options passed to gcc, such as -O2")
+    parser.add_argument("--runs", type=int, default=5,
+                        help="timed runs of each program (default 5)")
+    parser.add_argument("--output", default="bench_results.json")
+    parser.add_argument("--baseline",
+                        help="results file to compare the results with")
+    parser.add_argument("--threshold", type=float, default=10,
+                        help="percent change that counts as a regression "
+                             "(default 10)")
+    args = parser.parse_args()
+
+    programs = args.programs or sorted(
+        f[:-len(".fish")] for f in os.listdir(BENCH) if f.endswith(".fish"))
+
+    results = {
+        "sailfishc": args.sailfishc,
+        "flags": args.flags,
+        "cc": args.cc,
+        "cflags": args.cflags,
+        "runs": args.runs,
+        "benchmarks": {},
+    }
+    failed = False
+    print("%-20s %10s %10s %10s %12s" %
+          ("benchmark", "compile", "gcc", "run", "peak memory"))
+    for name in programs:
+        result = run_benchmark(args, name)
+        if result is None:
+            print("%-20s failed" % name)
+            failed = True
+            continue
+        results["benchmarks"][name] = result
+        print("%-20s %8.1fms %8.1fms %8.1fms %10dKB" %
+              (name, result["compile_ms"], result["gcc_ms"],
+               result["run_ms"], result["peak_rss_kb"]))
+
+    with open(args.output, "w") as out:
+        json.dump(results, out, indent=2, sort_keys=True)
+        out.write("\n")
+    print("Wrote results to: " + args.output)
+
+    if args.baseline:
+        with open(args.baseline) as f:
+            baseline = json.load(f)
+        if compare(baseline, results, args.threshold, not args.programs):
+            failed = True
+
+    return 1 if failed else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,18 @@
+#!/bin/bash
+# Times the list kernels against the recursive sailfish code they replace,
+# once per simd level. Run from the build directory:
+#     ../bench/run_kernels.sh
+SAILFISHC=${SAILFISHC:-./sailfishc}
+BENCH=$(dirname "$0")
+
+for program in kernels_recursive kernels; do
+    $SAILFISHC "$BENCH/$program.fish" > /dev/null || exit 1
+    gcc out.c -o "$program" || exit 1
+done
+
+echo "recursive sailfish:"
+time ./kernels_recursive
+for level in 2 1 0; do
+    echo "kernels, SAILFISH_SIMD=$level:"
+    time env SAILFISH_SIMD=$level ./kernels
+done
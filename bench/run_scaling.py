@@ -0,0 +1,176 @@
+#!/usr/bin/env python3
+"""Sweeps the size of programs written by gen_program.py one dimension at a
+time, timing sailfishc on each, and plots compile time against size. A curve
+whose time grows faster than n log n over its largest sizes is flagged, since
+that is how a quadratic loop in the compiler first shows. Run from the build
+directory:
+    ../bench/run_scaling.py [--runs 5] [--png scaling.png] [functions ...]
+It writes every measurement to scaling_results.csv and exits with 1 if any
+curve was flagged.
+"""
+import argparse
+import math
+import os
+import shutil
+import statistics
+import subprocess
+import sys
+import tempfile
+import time
+
+import gen_program
+
+# the sizes each dimension is swept over, the others staying at their
+# gen_program.py defaults
+SWEEPS = {
+    "functions": [50, 100, 200, 400, 800, 1600, 3200],
+    "imports": [4, 8, 16, 32, 64, 128, 256],
+    "statements": [16, 32, 64, 128, 256, 512, 1024],
+    "depth": [2, 4, 8, 16, 32, 64, 128],
+    "list": [128, 256, 512, 1024, 2048, 4096, 8192],
+}
+
+# the largest sizes of a sweep, whose growth is tested
+TAIL = 3
+
+
+def linearithmic(n):
+    return n * math.log2(n + 1)
+
+
+def compile_time(args, work, sizes):
+    """Generates a program of the given sizes and returns the median time in
+    milliseconds sailfishc takes to compile it, or None if it failed."""
+    options = argparse.Namespace(**vars(args.defaults))
+    for name, size in sizes.items():
+        setattr(options, name, size)
+    options.output = os.path.join(work, "program")
+    main = gen_program.generate(options)
+
+    times = []
+    for _ in range(args.runs):
+        start = time.perf_counter()
+        sailfishc = subprocess.run([args.sailfishc, main], cwd=work,
+                                   capture_output=True, text=True)
+        times.append((time.perf_counter() - start) * 1000)
+        if "Successfully wrote compiled code" not in sailfishc.stdout:
+            print(sailfishc.stdout, file=sys.stderr)
+            return None
+    shutil.rmtree(options.output)
+    return statistics.median(times)
+
+
+def growth(points):
+    """How much faster than n log n time grew over the largest sizes: the
+    geometric mean, over each step, of the growth in time divided by the
+    growth in n log n. Fixed costs such as starting sailfishc only make it
+    smaller."""
+    tail = points[-TAIL:]
+    ratios = []
+    for (n0, t0), (n1, t1) in zip(tail, tail[1:]):
+        ratios.append((t1 / t0) / (linearithmic(n1) / linearithmic(n0)))
+    return math.exp(sum(math.log(r) for r in ratios) / len(ratios))
+
+
+def exponent(points):
+    """The power of n the time grew with over the largest sizes."""
+    (n0, t0), (n1, t1) = points[-TAIL], points[-1]
+    return math.log(t1 / t0) / math.log(n1 / n0)
+
+
+def plot(name, points, width=50):
+    """Draws the times as bars, scaled to the slowest."""
+    slowest = max(t for _, t in points)
+    print("\n%s" % name)
+    for n, t in points:
+        bar = "#" * max(1, round(width * t / slowest))
+        print("%8d %10.1fms %s" % (n, t, bar))
+
+
+def plot_png(path, curves):
+    try:
+        import matplotlib
+        matplotlib.use("Agg")
+        import matplotlib.pyplot as pyplot
+    except ImportError:
+        print("matplotlib is not installed, not writing " + path,
+              file=sys.stderr)
+        return
+
+    figure, axes = pyplot.subplots(1, len(curves),
+                                   figsize=(4 * len(curves), 3.5))
+    if len(curves) == 1:
+        axes = [axes]
+    for axis, (name, points) in zip(axes, curves.items()):
+        axis.loglog([n for n, _ in points], [t for _, t in points], "o-")
+        axis.set_title(name)
+        axis.set_xlabel("size")
+        axis.set_ylabel("compile ms")
+    figure.tight_layout()
+    figure.savefig(path)
+    print("Wrote plot to: " + path)
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description="Sweep program sizes and time sailfishc on each.")
+    parser.add_argument("dimensions", nargs="*",
+                        help="dimensions to sweep, all by default: " +
+                             ", ".join(SWEEPS))
+    parser.add_argument("--sailfishc", default="./sailfishc")
+    parser.add_argument("--runs", type=int, default=3,
+                        help="timed compiles of each program (default 3)")
+    parser.add_argument("--tolerance", type=float, default=1.25,
+                        help="how many times faster than n log n a curve "
+                             "may grow before it is flagged (default 1.25)")
+    parser.add_argument("--output", default="scaling_results.csv")
+    parser.add_argument("--png", help="also plot the curves to this file, "
+                                      "if matplotlib is installed")
+    args = parser.parse_args()
+    for name in args.dimensions:
+        if name not in SWEEPS:
+            parser.error("no dimension " + name)
+    args.sailfishc = os.path.abspath(args.sailfishc)
+
+    defaults = argparse.ArgumentParser()
+    gen_program.add_size_arguments(defaults)
+    args.defaults = defaults.parse_args([])
+
+    curves = {}
+    flagged = []
+    failed = False
+    with tempfile.TemporaryDirectory() as work, open(args.output, "w") as csv:
+        csv.write("dimension,size,compile_ms\n")
+        for name in args.dimensions or list(SWEEPS):
+            points = []
+            for size in SWEEPS[name]:
+                ms = compile_time(args, work, {name: size})
+                if ms is None:
+                    print("%s=%d failed to compile" % (name, size))
+                    failed = True
+                    break
+                points.append((size, ms))
+                csv.write("%s,%d,%.3f\n" % (name, size, ms))
+            if len(points) < TAIL:
+                continue
+
+            curves[name] = points
+            plot(name, points)
+            ratio = growth(points)
+            verdict = "ok"
+            if ratio > args.tolerance:
+                verdict = "faster than n log n"
+                flagged.append(name)
+            print("%8s time ~ n^%.2f, %.2fx n log n per step: %s" %
+                  ("", exponent(points), ratio, verdict))
+    print("\nWrote results to: " + args.output)
+
+    if args.png and curves:
+        plot_png(args.png, curves)
+    if flagged:
+        print("Grew faster than n log n: " + ", ".join(flagged))
+    return 1 if flagged or failed else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
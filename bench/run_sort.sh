@@ -0,0 +1,16 @@
+#!/bin/bash
+# Times sortListInt against the merge sort from examples/mergesort.fish on
+# the same 50000 pseudo-random ints. Run from the build directory:
+#     ../bench/run_sort.sh
+SAILFISHC=${SAILFISHC:-./sailfishc}
+BENCH=$(dirname "$0")
+
+for program in sort_mergesort sort; do
+    $SAILFISHC "$BENCH/$program.fish" > /dev/null || exit 1
+    gcc out.c -o "$program" || exit 1
+done
+
+echo "mergesort.fish:"
+time ./sort_mergesort
+echo "sortListInt:"
+time ./sort
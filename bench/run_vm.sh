@@ -0,0 +1,20 @@
+#!/bin/bash
+# Times each bench program run by --run against compiling it with sailfishc
+# and gcc and running the binary, checking both print the same. Run from the
+# build directory:
+#     ../bench/run_vm.sh [program ...]
+SAILFISHC=${SAILFISHC:-./sailfishc}
+BENCH=$(dirname "$0")
+PROGRAMS=${@:-kernels kernels_recursive lists pool sort sort_mergesort \
+    strings traversal tree}
+
+for program in $PROGRAMS; do
+    echo "$program:"
+    echo "  --run"
+    time ($SAILFISHC --run "$BENCH/$program.fish" > "$program.vm.out")
+    echo "  sailfishc, gcc and a.out"
+    time ($SAILFISHC "$BENCH/$program.fish" > /dev/null &&
+        gcc -O2 out.c -lm -o "$program" && ./"$program" > "$program.gcc.out")
+    cmp -s "$program.vm.out" "$program.gcc.out" ||
+        echo "  OUTPUT DIFFERS: $program.vm.out $program.gcc.out"
+done
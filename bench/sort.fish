@@ -0,0 +1,21 @@
+# Same input as sort_mergesort.fish, sorted in place by sortListInt.
+
+(fun randoms([int] a, int x, int n)([int]) {
+    Tree (
+        ( | n > 0 | {
+            a = pushListInt(a, len(a), x)
+            return randoms(a, x * 75 % 65537, n - 1)
+        })
+    )
+    return a
+})
+
+start {
+    dec [int] a = []
+    a = randoms(a, 1, 50000)
+    a = sortListInt(a)
+    printInt(getAtIndexInt(a, 0))
+    dec int last = len(a)
+    last = last - 1
+    printInt(getAtIndexInt(a, last))
+}
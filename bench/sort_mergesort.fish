@@ -0,0 +1,101 @@
+import intListHandler : "../examples/intListHandler.fish"
+
+# Sorts pseudo-random ints with the merge sort from examples/mergesort.fish,
+# to compare with sort.fish. See run_sort.sh.
+
+# merges from a's i-th and b's j-th element on, then drops what was taken from
+# the front of the other list at once before appending its rest
+(fun merge_(intListHandler a, intListHandler b, intListHandler c, int i, int j) (intListHandler) {
+    Tree (
+        ( | i == a.size | {
+            b...removeFront(j)
+            c.list = appendListInt(c.list, b.list, c.size, b.size)
+            c.size = b.size + c.size
+            return c
+        })
+
+        ( | j == b.size | {
+            a...removeFront(i)
+            c.list = appendListInt(c.list, a.list, c.size, a.size)
+            c.size = a.size + c.size
+            return c
+        })
+
+        ( | a...peek(i) < b...peek(j) | {
+            dec int x = a...peek(i)
+            c...push(x)
+            return merge_(a, b, c, i + 1, j)
+        })
+    )
+
+    dec int y = b...peek(j)
+    c...push(y)
+    return merge_(a, b, c, i, j + 1)
+})
+
+(fun merge(intListHandler a, intListHandler b) (intListHandler) {
+    # create another empty list for merging
+    dec intListHandler c = new intListHandler { list: [], size: 0}
+    return merge_(a, b, c, 0, 0)
+})
+
+(fun sublist(intListHandler a, intListHandler b, int front, int back)(intListHandler) {
+    Tree (
+        ( | front == back | { 
+            dec int j = a...peek(front)
+            b...push(j)
+            return b
+        } )
+        ( | true | {
+            dec int j = a...peek(front)
+            b...push(j)
+            sublist(a, b, front+1, back)
+        })
+    )
+
+    return b
+})
+
+(fun mergesort(intListHandler a, int front, int end)(intListHandler) {
+    Tree (
+        ( | (front == end) or ((end - front) == 1) | {
+            dec int i = a...peek(front)
+            dec intListHandler b = new intListHandler { list: [i], size: 1}
+            return b
+        })
+    )
+
+    # find middle
+    dec int middle = (end - front) / 2
+
+    # generate two empty lists for recursively dividing
+    dec intListHandler f = new intListHandler { list: [], size: 0}
+    dec intListHandler b = new intListHandler { list: [], size: 0}
+
+    f = sublist(a, f, front, middle-1)
+    b = sublist(a, b, middle, end-1)
+
+    return merge(
+        mergesort(f, 0, f.size),
+        mergesort(b, 0, b.size)
+    )
+})
+
+(fun randoms(intListHandler a, int x, int n)(intListHandler) {
+    Tree (
+        ( | n > 0 | {
+            a...push(x)
+            return randoms(a, x * 75 % 65537, n - 1)
+        })
+    )
+    return a
+})
+
+start {
+    dec intListHandler a = new intListHandler { list: [], size: 0}
+    a = randoms(a, 1, 50000)
+    a = mergesort(a, 0, a.size)
+    printInt(a...peek(0))
+    dec int last = a.size - 1
+    printInt(a...peek(last))
+}
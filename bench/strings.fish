@@ -0,0 +1,38 @@
+# Prints strings and ints one at a time, the way sailfish programs report
+# results, then sorts and prints a list of strings. Output goes to a pipe or
+# a file, so it is block buffered.
+
+(fun shout(int i, int n)(void) {
+    Tree (
+        ( | i < n | {
+            printStr("the sailfish is the fastest fish in the sea")
+            printInt(i)
+            dec int parity = i % 2
+            printBool(parity == 0)
+            shout(i + 1, n)
+        })
+    )
+})
+
+(fun words([str] a, int x, int n)([str]) {
+    Tree (
+        ( | n > 0 | {
+            dec int m = x % 3
+            Tree (
+                ( | m == 0 | { a = pushListStr(a, len(a), "marlin") })
+                ( | m == 1 | { a = pushListStr(a, len(a), "swordfish") })
+                ( | true | { a = pushListStr(a, len(a), "sailfish") })
+            )
+            return words(a, x * 75 % 65537, n - 1)
+        })
+    )
+    return a
+})
+
+start {
+    shout(0, 1000000)
+    dec [str] a = ["tuna"]
+    a = words(a, 1, 50000)
+    a = sortListStr(a)
+    printListStr(a)
+}
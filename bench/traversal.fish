@@ -0,0 +1,30 @@
+import treenode : "../examples/treenode.fish"
+
+# Builds one binary search tree of 20000 nodes and walks it in order 100
+# times, printing every node.
+
+(fun build(treenode root, int x, int n)(treenode) {
+    Tree (
+        ( | n > 0 | {
+            dec treenode tn = new treenode { data: x, left: empty, right: empty }
+            root...addNode(tn)
+            return build(root, x * 75 % 65537, n - 1)
+        })
+    )
+    return root
+})
+
+(fun walk(treenode root, int r)(void) {
+    Tree (
+        ( | r > 0 | {
+            root...inorderTraversal(void)
+            walk(root, r - 1)
+        })
+    )
+})
+
+start {
+    dec treenode root = new treenode { data: 32768, left: empty, right: empty }
+    root = build(root, 1, 20000)
+    walk(root, 100)
+}
@@ -0,0 +1,32 @@
+# Builds and drops 100 binary search trees of 2000 nodes, releasing each one
+# back to an arena mark. See run_alloc.sh.
+
+import treenode : "../examples/treenode.fish"
+
+(fun build(treenode root, int x, int n)(treenode) {
+    Tree (
+        ( | n > 0 | {
+            dec treenode tn = new treenode { data: x, left: empty, right: empty }
+            root...addNode(tn)
+            return build(root, x * 75 % 65537, n - 1)
+        })
+    )
+    return root
+})
+
+(fun rounds(int r)(void) {
+    Tree (
+        ( | r > 0 | {
+            dec int mark = arenaMark(void)
+            dec treenode root = new treenode { data: 32768, left: empty, right: empty }
+            root = build(root, 1, 2000)
+            arenaRelease(mark)
+            rounds(r - 1)
+        })
+    )
+})
+
+start {
+    rounds(100)
+    resetArena(void)
+}
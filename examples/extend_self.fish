@@ -0,0 +1,9 @@
+# Extends a list with itself twice. The list grows, and so moves, while it is
+# being copied from.
+
+start {
+    dec [int] l = [1, 2, 3]
+    l = extendListInt(l, l, len(l), len(l))
+    l = appendListInt(l, l, len(l), len(l))
+    printListInt(l)
+}
@@ -19,10 +19,9 @@ Ufn{
         own...display_(0)
     })
 
-    # rather inefficient because we malloc every time
+    # amortized O(1), the list doubles its capacity when full
     (fun push(int i)(void){
-       dec [int] is = [i]
-       own.list = appendListInt(own.list, is, own.size, 1)
+       own.list = pushListInt(own.list, own.size, i)
        ++own.size
     })
 
@@ -39,12 +38,23 @@ Ufn{
         Tree (
             ( | own.size == 0 | { printStr("Sorry, list is empty!") })
             ( | true | {
-                own.list = deleteAtIndexInt(own.list, own.size, i)
+                own.list = removeAtIndexInt(own.list, own.size, i)
                 --own.size
             })
         )
     })
 
+    (fun removeFront(int n)(void){
+        Tree (
+            ( | n < 0 | { printStr("Sorry, can't remove a negative count!") })
+            ( | n > own.size | { printStr("Sorry, list is too short!") })
+            ( | true | {
+                own.list = removeRangeInt(own.list, own.size, 0, n)
+                own.size -= n
+            })
+        )
+    })
+
     (fun setAtIndex(int i, int v)(void){
        Tree (
            ( | (i > own.size) or (i < 0) | { printStr("Invalid index") } )
@@ -1,36 +1,39 @@
 import intListHandler : "../examples/intListHandler.fish"
 
-(fun merge(intListHandler a, intListHandler b) (intListHandler) {
-    # create another empty list for merging
-    dec intListHandler c = new intListHandler { list: [], size: 0}
-    
+# merges from a's i-th and b's j-th element on, then drops what was taken from
+# the front of the other list at once before appending its rest
+(fun merge_(intListHandler a, intListHandler b, intListHandler c, int i, int j) (intListHandler) {
     Tree (
-        ( | a.size == 0 | {
+        ( | i == a.size | {
+            b...removeFront(j)
             c.list = appendListInt(c.list, b.list, c.size, b.size)
             c.size = b.size + c.size
             return c
         })
 
-        ( | b.size == 0 | {
+        ( | j == b.size | {
+            a...removeFront(i)
             c.list = appendListInt(c.list, a.list, c.size, a.size)
             c.size = a.size + c.size
             return c
         })
 
-        ( | a...peek_front(void) < b...peek_front(void) | {
-            dec int i = a...peek_front(void)
-            c...push(i)
-            a...removeByIndex(0)
-        })
-
-        ( | a...peek_front(void) >= b...peek_front(void) | {
-            dec int i = b...peek_front(void)
-            c...push(i)
-            b...removeByIndex(0)
+        ( | a...peek(i) < b...peek(j) | {
+            dec int x = a...peek(i)
+            c...push(x)
+            return merge_(a, b, c, i + 1, j)
         })
     )
 
-    return merge(a,b,c)
+    dec int y = b...peek(j)
+    c...push(y)
+    return merge_(a, b, c, i, j + 1)
+})
+
+(fun merge(intListHandler a, intListHandler b) (intListHandler) {
+    # create another empty list for merging
+    dec intListHandler c = new intListHandler { list: [], size: 0}
+    return merge_(a, b, c, 0, 0)
 })
 
 (fun sublist(intListHandler a, intListHandler b, int front, int back)(intListHandler) {
@@ -57,6 +60,7 @@ import intListHandler : "../examples/intListHandler.fish"
             dec intListHandler b = new intListHandler { list: [i], size: 1}
             return b
         })
+    )
 
     # find middle
     dec int middle = (end - front) / 2
@@ -0,0 +1,49 @@
+# Exercises the rewrites sailfishc makes to the C it writes: folded constants,
+# including powers, pruned Tree branches, a Tree lowered to a switch and a
+# pure call in several guards cached in a cse_ temporary.
+
+(fun square(int n)(int) {
+    return n * n
+})
+
+(fun name(int day)(str) {
+    Tree (
+        ( | day == 1 | { return "mon" })
+        ( | day == 2 | { return "tue" })
+        ( | day == 3 | { return "wed" })
+        ( | true | { return "other" })
+    )
+    return "never"
+})
+
+(fun size(int n)(str) {
+    Tree (
+        ( | 10 > square(n) | { return "small" })
+        ( | 100 > square(n) | { return "medium" })
+    )
+    return "large"
+})
+
+start {
+    dec int k = 2 ** 3 + 1
+    printInt(k * 2)
+    dec int m = 3 * 2 ** 2 - 1
+    printInt(m)
+    dec flt f = 1.5 * 2.0
+    printFlt(f ** 2.0 + 1.0)
+    dec int changed = 1
+    changed = changed + 4
+    printInt(changed)
+
+    Tree (
+        ( | k < 0 | { printStr("pruned") })
+        ( | k == 9 | { printStr("kept") })
+        ( | false | { printStr("pruned") })
+    )
+
+    printStr(name(2))
+    printStr(name(7))
+    printStr(size(2))
+    printStr(size(5))
+    printStr(size(20))
+}
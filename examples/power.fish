@@ -0,0 +1,19 @@
+# ** binds tighter than the other operators and groups to the right. The
+# powers in start are folded by sailfishc, those in powers are computed.
+
+(fun powers(int x, flt g)(void) {
+    printInt(x ** 2 + 1)
+    printInt(2 * x ** 3)
+    printInt(x ** x - 1)
+    printInt(x ** 2 ** 2 + 1)
+    printFlt(g ** 2.0 - 1.0)
+    printFlt(g ** 3.0 + g ** 0.5)
+})
+
+start {
+    printInt(2 ** 3 + 1)
+    printInt(2 * 3 ** 2)
+    printInt(2 ** 3 ** 2)
+    printFlt(3.0 ** 2.0 - 1.0)
+    powers(3, 3.0)
+}
@@ -0,0 +1,24 @@
+# Recurses 10 million times. Each self call is in tail position, so sailfishc
+# turns it into a jump and the C stack never grows; without that this would
+# overflow an 8MB stack long before finishing.
+
+(fun count(int i, int n)(int) {
+    Tree (
+        ( | i < n | { return count(i + 1, n) })
+    )
+    return i
+})
+
+(fun countdown(int n)(void) {
+    Tree (
+        ( | n > 0 | {
+            n -= 1
+            countdown(n)
+        })
+    )
+})
+
+start {
+    countdown(10000000)
+    printInt(count(0, 10000000))
+}
@@ -30,7 +30,8 @@ Ufn{
            })
 
            ( | (tn.data < own.data) and (own...hasLeft(void)) | {
-               own.left...addNode(tn)
+               dec treenode child = own.left
+               child...addNode(tn)
            })
 
            ( | (tn.data >= own.data) and (!own...hasRight(void)) | {
@@ -38,7 +39,8 @@ Ufn{
            })
 
            ( | (tn.data >= own.data) and (own...hasRight(void))  | {
-               own.right...addNode(tn)
+               dec treenode child = own.right
+               child...addNode(tn)
            })
        )
    })
@@ -47,7 +49,8 @@ Ufn{
         Tree (
             # left 
             ( | own...hasLeft(void) | { 
-                own.left...inorderTraversal(void)
+                dec treenode child = own.left
+                child...inorderTraversal(void)
             })
         )
 
@@ -57,7 +60,8 @@ Ufn{
         Tree (
             # right 
             ( | own...hasRight(void) | { 
-               own.right...inorderTraversal(void)
+               dec treenode child = own.right
+               child...inorderTraversal(void)
             })
        )
    })
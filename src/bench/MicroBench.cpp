@@ -0,0 +1,249 @@
+/*
+ * Robert Durst 2019
+ * Sailfish Programming Language
+ *
+ * Micro-benchmarks of the compiler's hot paths: the Lexar, a whole
+ * sailfishc::parse and the SymbolTable. Each benchmark is run a few times to
+ * warm up and then timed over a number of repetitions, and the time per
+ * operation is reported at the median, 90th and 99th percentile along with
+ * the throughput at the median. Inputs are synthetic Sailfish programs
+ * generated here, so the numbers only compare builds of sailfishc with each
+ * other. Build with optimizations, for example -DCMAKE_BUILD_TYPE=Release.
+ * The program parsed is written to microbench.fish in the working directory
+ * and removed at exit; parsing generates its C in memory without writing out.c.
+ *
+ *     sailfishc_microbench [--warmup N] [--repetitions N] [name ...]
+ */
+#include "../lexar/Lexar.h"
+#include "../sailfish/sailfishc.h"
+#include "../semantics/SymbolTable.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// one repetition of a benchmark does its work once and returns how many
+// operations that was
+struct MicroBenchmark
+{
+    std::string name;
+    std::string unit;
+    std::function<long()> repetition;
+};
+
+// a program of the given number of functions, each declaring, branching,
+// calling and doing arithmetic, which parses without errors
+std::string
+syntheticProgram(int functions)
+{
+    std::string source;
+    for (int i = 0; i < functions; ++i)
+    {
+        auto f = "f" + std::to_string(i);
+        source += "# function " + std::to_string(i) + "\n"
+                  "(fun " + f + "(int a, int b)(int) {\n"
+                  "    dec int x = a + b * " + std::to_string(i) + "\n"
+                  "    dec flt y = 1.5 * 2.0\n"
+                  "    dec str s = \"sailfish\"\n"
+                  "    x = x % 7 - 3\n"
+                  "    Tree (\n"
+                  "        ( | x < 0 | { return 0 - x })\n"
+                  "        ( | x == 3 | { return " + f + "(x - 1, b) })\n"
+                  "        ( | true | { dec int z = x * x\n"
+                  "                     return z + a })\n"
+                  "    )\n"
+                  "    return x\n"
+                  "})\n\n";
+    }
+    return source + "start {\n    printInt(f0(1, 2))\n}\n";
+}
+
+std::string
+writeProgram(const std::string& path, const std::string& source)
+{
+    std::ofstream(path) << source;
+    return path;
+}
+
+// lexes to the end of the input, returning the number of tokens
+long
+lexAll(const std::string& input, bool isFile)
+{
+    Lexar lexar(input, isFile);
+    long tokens = 0;
+    while (lexar.getNextToken()->kind != TokenKind::EOF_)
+        ++tokens;
+    return tokens;
+}
+
+std::vector<MicroBenchmark>
+microBenchmarks()
+{
+    static auto program = syntheticProgram(200);
+    static auto small = syntheticProgram(10);
+    static auto file = writeProgram("microbench.fish", program);
+    static auto tokens = lexAll(file, true);
+
+    // names made up front so that only the table is timed
+    static std::vector<std::string> names;
+    for (int i = 0; names.size() < 2000; ++i)
+        names.push_back("variable" + std::to_string(i));
+
+    return {
+        {"lex_file", "token", []() { return lexAll(file, true); }},
+        {"lex_string", "token", []() { return lexAll(small, false); }},
+        {"parse", "token",
+         []() {
+             sailfishc parser(file, false);
+             parser.parse();
+             return tokens;
+         }},
+        {"symbol_insert", "symbol",
+         []() {
+             SymbolTable table;
+             table.enterScope();
+             for (auto const& name : names)
+                 table.addSymbol(name, "int");
+             return (long)names.size();
+         }},
+        {"symbol_lookup", "lookup",
+         []() {
+             static SymbolTable table;
+             static bool filled = false;
+             if (!filled)
+             {
+                 table.enterScope();
+                 for (auto const& name : names)
+                     table.addSymbol(name, "int");
+                 filled = true;
+             }
+
+             long found = 0;
+             for (auto const& name : names)
+                 found += table.hasVariable(name) &&
+                          table.getSymbolType(name) == "int";
+             return found;
+         }},
+        {"scope_enter_exit", "scope",
+         []() {
+             // a function's worth of declarations in each scope
+             SymbolTable table;
+             for (int i = 0; i < 1000; ++i)
+             {
+                 table.enterScope();
+                 for (int j = 0; j < 8; ++j)
+                     table.addSymbol(names[j], "int");
+                 table.exitScope();
+             }
+             return 1000L;
+         }},
+    };
+}
+
+double
+percentile(const std::vector<double>& sorted, double p)
+{
+    auto at = (size_t)(p * (sorted.size() - 1) + 0.5);
+    return sorted[std::min(at, sorted.size() - 1)];
+}
+
+void
+runMicroBenchmark(const MicroBenchmark& benchmark, int warmup,
+                  int repetitions)
+{
+    for (int i = 0; i < warmup; ++i)
+        benchmark.repetition();
+
+    std::vector<double> perOperation;
+    long operations = 0;
+    for (int i = 0; i < repetitions; ++i)
+    {
+        auto start = std::chrono::steady_clock::now();
+        operations = benchmark.repetition();
+        auto end = std::chrono::steady_clock::now();
+
+        std::chrono::duration<double, std::nano> elapsed = end - start;
+        perOperation.push_back(elapsed.count() / std::max(operations, 1L));
+    }
+    std::sort(perOperation.begin(), perOperation.end());
+
+    auto median = percentile(perOperation, 0.5);
+    std::cout << std::left << std::setw(18) << benchmark.name << std::right
+              << std::setw(10) << operations << " " << std::left
+              << std::setw(7) << benchmark.unit << std::right << std::fixed
+              << std::setprecision(1) << std::setw(10) << median
+              << std::setw(10) << percentile(perOperation, 0.9)
+              << std::setw(10) << percentile(perOperation, 0.99)
+              << std::setw(12) << 1e3 / median << "\n"
+              << std::defaultfloat;
+}
+
+int
+usage(std::ostream& out, int status)
+{
+    out << "usage: sailfishc_microbench [--warmup N] [--repetitions N] "
+           "[name ...]\n\nbenchmarks:";
+    for (auto const& benchmark : microBenchmarks())
+        out << " " << benchmark.name;
+    out << "\n";
+
+    // listing the benchmarks made their input
+    std::remove("microbench.fish");
+    return status;
+}
+
+int
+main(int argc, char** argv)
+{
+    int warmup = 3;
+    int repetitions = 30;
+    std::vector<std::string> only;
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string arg = argv[i];
+        auto isCount = (arg == "--warmup" || arg == "--repetitions") &&
+                       i + 1 < argc &&
+                       std::string(argv[i + 1]).find_first_not_of(
+                           "0123456789") == std::string::npos;
+        if (arg == "--help")
+            return usage(std::cout, 0);
+        else if (arg == "--warmup" && isCount)
+            warmup = std::stoi(argv[++i]);
+        else if (arg == "--repetitions" && isCount)
+            repetitions = std::max(1, std::stoi(argv[++i]));
+        else if (arg.rfind("--", 0) == 0)
+        {
+            std::cerr << "Unknown option or missing count: " << arg << "\n";
+            return usage(std::cerr, 1);
+        }
+        else
+            only.push_back(arg);
+    }
+
+    // a misspelt name would otherwise run nothing
+    auto const& benchmarks = microBenchmarks();
+    for (auto const& name : only)
+        if (std::none_of(benchmarks.begin(), benchmarks.end(),
+                         [&name](auto const& b) { return b.name == name; }))
+        {
+            std::cerr << "Unknown benchmark: " << name << "\n";
+            return usage(std::cerr, 1);
+        }
+
+    std::cout << std::left << std::setw(18) << "benchmark" << std::right
+              << std::setw(18) << "operations" << std::setw(10) << "p50 ns"
+              << std::setw(10) << "p90 ns" << std::setw(10) << "p99 ns"
+              << std::setw(12) << "M ops/s" << "\n";
+    for (auto const& benchmark : benchmarks)
+        if (only.empty() || std::find(only.begin(), only.end(),
+                                      benchmark.name) != only.end())
+            runMicroBenchmark(benchmark, warmup, repetitions);
+
+    std::remove("microbench.fish");
+    return 0;
+}
@@ -0,0 +1,60 @@
+/*
+ * Robert Durst 2019
+ * Sailfish Programming Language
+ */
+#include "BranchProfile.h"
+#include <fstream>
+#include <sstream>
+
+bool
+BranchProfile::load(const std::string& path)
+{
+    std::ifstream profile(path);
+    if (!profile.good())
+        return false;
+
+    // one "file\tline\tcolumn\tbranch\tcount" line per branch a run took
+    std::string line;
+    while (std::getline(profile, line))
+    {
+        auto tab = line.find('\t');
+        if (tab == std::string::npos)
+            return false;
+
+        int treeLine, column, branch;
+        long count;
+        std::istringstream fields(line.substr(tab + 1));
+        if (!(fields >> treeLine >> column >> branch >> count))
+            return false;
+
+        auto tree = std::make_tuple(line.substr(0, tab), treeLine, column);
+        trees[tree][branch] += count;
+    }
+
+    return true;
+}
+
+bool
+BranchProfile::hasTree(const std::string& file, int line, int column)
+{
+    return trees.find(std::make_tuple(file, line, column)) != trees.end();
+}
+
+long
+BranchProfile::getCount(const std::string& file, int line, int column,
+                        int branch)
+{
+    auto tree = trees.find(std::make_tuple(file, line, column));
+    if (tree == trees.end())
+        return 0;
+
+    auto count = tree->second.find(branch);
+    return count == tree->second.end() ? 0 : count->second;
+}
+
+BranchProfile&
+branchProfile()
+{
+    static BranchProfile profile;
+    return profile;
+}
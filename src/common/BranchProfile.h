@@ -0,0 +1,31 @@
+/*
+ * Robert Durst 2019
+ * Sailfish Programming Language
+ *
+ * BranchProfile holds how often each Tree branch was taken, as counted by a
+ * program compiled with --profile-generate and read back with --profile-use.
+ * A Tree is known by the file, line and column of its 'Tree' and its branches
+ * by their place in the source, from 1; branch 0 counts how often the Tree was
+ * reached. Every run of the program adds its counts to the file, so counts for
+ * the same branch are summed. Like CompileStats there is one profile for the
+ * whole run, shared by the sailfishc instances compiling imports.
+ */
+#pragma once
+#include <map>
+#include <string>
+#include <tuple>
+
+class BranchProfile
+{
+  private:
+    std::map<std::tuple<std::string, int, int>, std::map<int, long>> trees;
+
+  public:
+    // reads a profile written by a program compiled with --profile-generate
+    bool load(const std::string& path);
+
+    bool hasTree(const std::string& file, int line, int column);
+    long getCount(const std::string& file, int line, int column, int branch);
+};
+
+BranchProfile& branchProfile();
@@ -0,0 +1,56 @@
+/*
+ * Robert Durst 2019
+ * Sailfish Programming Language
+ *
+ * CompileStats counts what sailfishc did while compiling. Unlike the options,
+ * there is one for the whole run so that the sailfishc instances compiling
+ * imports add to the same counts.
+ */
+#pragma once
+#include <map>
+#include <string>
+
+struct CompileStats
+{
+    // constant expressions replaced by their value, including variables
+    // replaced by the constant they were declared with
+    int foldedExpressions = 0;
+
+    // Tree branches dropped or made unconditional by a constant guard
+    int prunedBranches = 0;
+
+    // Trees generated as a switch rather than an if chain
+    int switchTrees = 0;
+
+    // repeated pure calls in Tree guards replaced by a temporary
+    int cachedCalls = 0;
+
+    // Trees whose branches were reordered, and guards hinted as likely or
+    // unlikely, by the branch profile
+    int reorderedTrees = 0;
+    int hintedBranches = 0;
+
+    // volume counters, printed with --stats: tokens made by every Lexar by
+    // kind, including the UDT pre-scan, and the source bytes they read
+    std::map<std::string, long> tokens;
+    long bytesLexed = 0;
+
+    // symbols added to and scopes entered in every SymbolTable, and the
+    // entries copied while recording which symbols belong to a scope
+    long symbolsInserted = 0;
+    long scopesEntered = 0;
+    long localCacheCopies = 0;
+
+    long udtsRegistered = 0;
+    long errorsCreated = 0;
+
+    // bytes written to out.c, stdlib included
+    long bytesEmitted = 0;
+};
+
+inline CompileStats&
+compileStats()
+{
+    static CompileStats stats;
+    return stats;
+}
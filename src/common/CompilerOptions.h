@@ -0,0 +1,48 @@
+/*
+ * Robert Durst 2019
+ * Sailfish Programming Language
+ *
+ * CompilerOptions collects the command line flags which change how code is
+ * generated. It is handed to every sailfishc instance, including the ones
+ * compiling imports, so that all of out.c is generated the same way.
+ */
+#pragma once
+#include <string>
+
+struct CompilerOptions
+{
+    // include the precompiled runtime's header and link its library instead
+    // of writing the whole stdlib into out.c
+    bool linkRuntime = false;
+
+    // flush printed output after every line rather than when the buffer
+    // fills; the runtime already does this when stdout is a terminal
+    bool lineBuffered = false;
+
+    // allocate UDT instances and lists from the runtime's arena instead of
+    // with malloc
+    bool arenaAllocation = false;
+
+    // replace calls to functions and methods whose body is a single return
+    // with the returned expression
+    bool inlineCalls = false;
+
+    // count the calls of every function and method and time them, printing
+    // a profile when the program exits
+    bool instrument = false;
+
+    // where a program sampling its own call stack writes the folded stacks
+    // when it exits, or "" to not sample
+    std::string sampleFile = "";
+
+    // precede every statement with a #line directive naming the Sailfish
+    // file and line it came from
+    bool lineDirectives = false;
+
+    // where a program counting how often each Tree branch is taken adds the
+    // counts when it exits, or "" to not count
+    std::string profileGenerateFile = "";
+
+    // write out.c once the program checks; --run only checks it
+    bool writeOutput = true;
+};
\ No newline at end of file
@@ -0,0 +1,63 @@
+/*
+ * Robert Durst 2019
+ * Sailfish Programming Language
+ */
+#include "HeapStats.h"
+#include <cstdlib>
+#include <new>
+
+// plain counters: they must work before any static is constructed, and the
+// compiler is single threaded
+static long allocations = 0;
+static long frees = 0;
+static long bytes = 0;
+
+HeapStats
+heapStats()
+{
+    return HeapStats{allocations, frees, bytes};
+}
+
+void*
+operator new(std::size_t size)
+{
+    ++allocations;
+    bytes += size;
+
+    // malloc(0) may return null, which new may not
+    if (void* p = std::malloc(size ? size : 1))
+        return p;
+    throw std::bad_alloc();
+}
+
+void*
+operator new[](std::size_t size)
+{
+    return operator new(size);
+}
+
+void
+operator delete(void* p) noexcept
+{
+    if (p)
+        ++frees;
+    std::free(p);
+}
+
+void
+operator delete[](void* p) noexcept
+{
+    operator delete(p);
+}
+
+void
+operator delete(void* p, std::size_t) noexcept
+{
+    operator delete(p);
+}
+
+void
+operator delete[](void* p, std::size_t) noexcept
+{
+    operator delete(p);
+}
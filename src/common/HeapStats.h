@@ -0,0 +1,19 @@
+/*
+ * Robert Durst 2019
+ * Sailfish Programming Language
+ *
+ * HeapStats counts the compiler's own heap use. sailfishc replaces the global
+ * operator new and delete with ones that count before calling malloc and free;
+ * they are built into the executable rather than the library so that the
+ * linker always picks them over the standard ones.
+ */
+#pragma once
+
+struct HeapStats
+{
+    long allocations;
+    long frees;
+    long bytes; // requested by every allocation, whether freed or not
+};
+
+HeapStats heapStats();
@@ -0,0 +1,241 @@
+/*
+ * Robert Durst 2019
+ * Sailfish Programming Language
+ */
+#include "TimeReport.h"
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <sys/resource.h>
+
+TimeReport::TimeReport()
+{
+    enabled = false;
+    epoch = std::chrono::steady_clock::now();
+    cpuEpoch = 0;
+}
+
+void
+TimeReport::enable(const std::string& path)
+{
+    enabled = true;
+    tracePath = path;
+    epoch = std::chrono::steady_clock::now();
+    cpuEpoch = 0;
+    cpuEpoch = cpuNow();
+}
+
+bool
+TimeReport::isEnabled()
+{
+    return enabled;
+}
+
+double
+TimeReport::now()
+{
+    return std::chrono::duration<double, std::micro>(
+               std::chrono::steady_clock::now() - epoch)
+        .count();
+}
+
+double
+TimeReport::cpuNow()
+{
+    double us = 0;
+    for (auto who : {RUSAGE_SELF, RUSAGE_CHILDREN})
+    {
+        rusage usage;
+        getrusage(who, &usage);
+        us += (usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) * 1e6 +
+              usage.ru_utime.tv_usec + usage.ru_stime.tv_usec;
+    }
+    return us - cpuEpoch;
+}
+
+void
+TimeReport::begin(const std::string& name, const std::string& file)
+{
+    Event e;
+    e.name = name;
+    e.file = file;
+    e.depth = open.size();
+    e.start = now();
+    e.wall = 0;
+    e.cpu = cpuNow(); // the start, until the scope ends
+    e.children = 0;
+
+    open.push_back(events.size());
+    events.push_back(e);
+}
+
+void
+TimeReport::end()
+{
+    auto& e = events[open.back()];
+    open.pop_back();
+
+    e.wall = now() - e.start;
+    e.cpu = cpuNow() - e.cpu;
+    if (!open.empty())
+        events[open.back()].children += e.wall;
+}
+
+void
+TimeReport::tally(const std::string& name, const std::string& file,
+                  double wall)
+{
+    tallies[std::make_tuple(name, file)] += wall;
+}
+
+void
+TimeReport::report(std::ostream& out)
+{
+    // a file compiled twice shows up as one row per phase
+    struct Row
+    {
+        std::string name;
+        std::string file;
+        double wall = 0;
+        double self = 0;
+        double cpu = -1;
+    };
+
+    std::map<std::tuple<std::string, std::string>, Row> rows;
+    double total = 0;
+    for (auto const& e : events)
+    {
+        auto& row = rows[std::make_tuple(e.name, e.file)];
+        row.name = e.name;
+        row.file = e.file;
+        row.wall += e.wall;
+        row.self += e.wall - e.children;
+        row.cpu = std::max(row.cpu, 0.0) + e.cpu;
+        if (e.depth == 0)
+            total += e.wall;
+    }
+
+    // tallied phases have no nested scopes and are not timed in CPU
+    for (auto const& tally : tallies)
+    {
+        auto& row = rows[tally.first];
+        row.name = std::get<0>(tally.first);
+        row.file = std::get<1>(tally.first);
+        row.wall += tally.second;
+        row.self += tally.second;
+    }
+
+    std::vector<Row> sorted;
+    for (auto const& row : rows)
+        sorted.push_back(row.second);
+    std::stable_sort(
+        sorted.begin(), sorted.end(),
+        [](const Row& a, const Row& b) { return a.wall > b.wall; });
+
+    size_t width = std::string("file").size();
+    for (auto const& row : sorted)
+        width = std::max(width, row.file.size());
+
+    auto ms = [](double us) { return us / 1000; };
+    out << "Time report (ms; lex is part of parse, import is part of the "
+           "parse importing it)\n"
+        << std::left << std::setw(10) << "phase" << std::setw(width + 2)
+        << "file" << std::right << std::setw(10) << "wall" << std::setw(10)
+        << "self" << std::setw(10) << "cpu" << std::setw(8) << "%"
+        << "\n";
+
+    out << std::fixed << std::setprecision(3);
+    for (auto const& row : sorted)
+    {
+        out << std::left << std::setw(10) << row.name << std::setw(width + 2)
+            << row.file << std::right << std::setw(10) << ms(row.wall)
+            << std::setw(10) << ms(row.self);
+        if (row.cpu < 0)
+            out << std::setw(10) << "-";
+        else
+            out << std::setw(10) << ms(row.cpu);
+        out << std::setw(7) << std::setprecision(1)
+            << (total > 0 ? 100 * row.wall / total : 0) << "%"
+            << std::setprecision(3) << "\n";
+    }
+    out << std::defaultfloat;
+
+    if (tracePath != "")
+    {
+        if (writeTrace())
+            out << "Wrote trace events to: " << tracePath << "\n";
+        else
+            out << "Unable to write trace events to: " << tracePath << "\n";
+    }
+}
+
+// escapes a file name for a JSON string
+std::string
+jsonString(const std::string& s)
+{
+    std::string escaped = "\"";
+    for (auto c : s)
+    {
+        if (c == '"' || c == '\\')
+            escaped += '\\';
+        escaped += c;
+    }
+    return escaped + "\"";
+}
+
+bool
+TimeReport::writeTrace()
+{
+    std::ofstream trace(tracePath);
+    if (!trace.good())
+        return false;
+
+    // complete events, which trace viewers nest by their times
+    trace << "{\"traceEvents\":[";
+    for (size_t i = 0; i < events.size(); ++i)
+    {
+        auto const& e = events[i];
+        trace << (i ? ",\n" : "\n") << "{\"name\":" << jsonString(e.name)
+              << ",\"cat\":\"sailfishc\",\"ph\":\"X\",\"pid\":1,\"tid\":1"
+              << ",\"ts\":" << e.start << ",\"dur\":" << e.wall
+              << ",\"args\":{\"file\":" << jsonString(e.file)
+              << ",\"cpu_us\":" << e.cpu << "}}";
+    }
+    trace << "\n],\"displayTimeUnit\":\"ms\"}\n";
+
+    return trace.good();
+}
+
+TimeReport&
+timeReport()
+{
+    static TimeReport report;
+    return report;
+}
+
+TimeScope::TimeScope(const std::string& name, const std::string& file)
+{
+    recording = timeReport().isEnabled();
+    if (recording)
+        timeReport().begin(name, file);
+}
+
+TimeScope::~TimeScope()
+{
+    if (recording)
+        timeReport().end();
+}
+
+TimeTally::TimeTally(const char* n, const std::string& f) : file(f)
+{
+    name = n;
+    recording = timeReport().isEnabled();
+    if (recording)
+        start = timeReport().now();
+}
+
+TimeTally::~TimeTally()
+{
+    if (recording)
+        timeReport().tally(name, file, timeReport().now() - start);
+}
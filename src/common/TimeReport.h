@@ -0,0 +1,88 @@
+/*
+ * Robert Durst 2019
+ * Sailfish Programming Language
+ *
+ * TimeReport records how long each phase of a compile takes, in wall and CPU
+ * time, when sailfishc is run with --time-report. Phases are nested scopes,
+ * one per file, so an import's compile shows up inside the parse of the file
+ * importing it. Lexing is interleaved with parsing token by token, so it is
+ * tallied per file rather than recorded as scopes. CPU time includes finished
+ * child processes, so that it covers gcc. Like CompileStats there is one
+ * report for the whole run.
+ */
+#pragma once
+#include <chrono>
+#include <map>
+#include <ostream>
+#include <string>
+#include <tuple>
+#include <vector>
+
+class TimeReport
+{
+  private:
+    // a finished or open scope, times in microseconds since the report began
+    struct Event
+    {
+        std::string name;
+        std::string file;
+        int depth;
+        double start;
+        double wall;
+        double cpu;
+        double children; // wall time of the scopes nested directly inside
+    };
+
+    bool enabled;
+    std::string tracePath;
+    std::chrono::steady_clock::time_point epoch;
+    double cpuEpoch;
+    std::vector<Event> events;
+    std::vector<int> open;
+    std::map<std::tuple<std::string, std::string>, double> tallies;
+
+    double cpuNow();
+
+  public:
+    TimeReport();
+
+    // start recording, writing a Chrome trace to tracePath if it is not ""
+    void enable(const std::string& tracePath);
+    bool isEnabled();
+    double now();
+
+    void begin(const std::string& name, const std::string& file);
+    void end();
+    void tally(const std::string& name, const std::string& file, double wall);
+
+    // prints the phases sorted by wall time and writes the trace, if asked to
+    void report(std::ostream&);
+    bool writeTrace();
+};
+
+TimeReport& timeReport();
+
+// records the enclosing C++ scope as a phase of the report
+class TimeScope
+{
+  private:
+    bool recording;
+
+  public:
+    TimeScope(const std::string& name, const std::string& file);
+    ~TimeScope();
+};
+
+// adds the enclosing C++ scope's wall time to a phase tallied per file
+class TimeTally
+{
+  private:
+    bool recording;
+    const char* name;
+    const std::string& file;
+    double start;
+
+  public:
+    TimeTally(const char* name, const std::string& file);
+    ~TimeTally();
+};
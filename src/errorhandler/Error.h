@@ -5,6 +5,7 @@
  * Simple utility class for formatting and displaying various types of errors.
  */
 #pragma once
+#include "../common/CompileStats.h"
 #include "../common/display.h"
 #include <iostream>
 #include <string>
@@ -31,6 +32,7 @@ class Error
         left = le;
         middle = mid;
         right = ri;
+        ++compileStats().errorsCreated;
     }
     // set method for receiving type to utilize internally
     void
@@ -42,6 +42,8 @@ Lexar::makeToken(const TokenKind& k, const std::string& v)
             kd = TokenKind::RETURN;
         else if (v == "new")
             kd = TokenKind::NEW;
+        else if (v == "delete")
+            kd = TokenKind::DELETE;
         else if (v == "and")
             kd = TokenKind::AND;
         else if (v == "or")
@@ -49,6 +51,7 @@ Lexar::makeToken(const TokenKind& k, const std::string& v)
         else if (v == "true" || v == "false")
             kd = TokenKind::BOOL;
     }
+    ++compileStats().tokens[displayKind(kd)];
     return std::make_unique<Token>(kd, v, col, line);
 }
 
@@ -63,6 +66,7 @@ Lexar::makeTokenPutback(const TokenKind& k, std::string& v, char& c)
 
     // put the char back in the filebuffer
     file.putback(c);
+    --compileStats().bytesLexed;
 
     // edge case where if the last char was a space, even though we want to
     // putback, the buffer itself won't be off by one
@@ -82,6 +86,7 @@ Lexar::getNextChar()
 
         char c;
         file.get(c);
+        ++compileStats().bytesLexed;
         return c;
     }
 
@@ -90,6 +95,7 @@ Lexar::getNextChar()
 
     char c = rawString.at(0);
     rawString.erase(0, 1);
+    ++compileStats().bytesLexed;
     return c;
 }
 
@@ -6,6 +6,7 @@
  * source code text file.
  */
 #pragma once
+#include "../common/CompileStats.h"
 #include "Token.h"
 #include <fstream>
 #include <memory>
@@ -27,6 +27,8 @@ displayKind(const TokenKind& k)
         return "RETURN";
     case TokenKind::NEW:
         return "NEW";
+    case TokenKind::DELETE:
+        return "DELETE";
     case TokenKind::IDENTIFIER:
         return "IDENTIFIER";
     case TokenKind::INTEGER:
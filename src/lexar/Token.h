@@ -22,6 +22,7 @@ enum class TokenKind
     IMPORT,
     RETURN,
     NEW,
+    DELETE,
 
     // Basic Literals
     IDENTIFIER,
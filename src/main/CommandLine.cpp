@@ -3,6 +3,14 @@
  * Sailfish Programming Language
  */
 #include "CommandLine.h"
+#include "../vm/BytecodeCompiler.h"
+#include "../vm/VM.h"
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <sys/resource.h>
+#include <unistd.h>
+#include <vector>
 
 const static std::string VERSION = "sailfishc 0.3.0 (Istiophoriformes)";
 
@@ -22,8 +30,42 @@ helpMessage()
                  "To get started, consider one of the following commands:\n"
               << bold
               << "\n\tsailfishc [filename]\n"
+                 "\n\tsailfishc --compile_c [filename]\n"
+                 "\n\tsailfishc --compile_and_execute [filename]\n"
+                 "\n\tsailfishc --run [filename]\n"
+                 "\n\tsailfishc --emit_runtime [directory]\n"
                  "\n\tsailfishc --help\n"
                  "\n\tsailfishc --version\n"
+              << normal
+              << "\nThe following flags may precede any compile command:\n"
+              << bold
+              << "\n\t--link_runtime\tlink the precompiled runtime library "
+                 "instead of\n\t\t\twriting the stdlib into out.c\n"
+                 "\n\t--line_buffered\tflush printed output after every "
+                 "line, even\n\t\t\twhen it is not a terminal\n"
+                 "\n\t--arena\t\tallocate UDTs and lists from an arena "
+                 "instead\n\t\t\tof with malloc\n"
+                 "\n\t--inline\treplace calls to one-expression functions "
+                 "and\n\t\t\tmethods with their expression\n"
+                 "\n\t--line_directives\n\t\t\tmark the C of every statement "
+                 "with the\n\t\t\tSailfish file and line it came from\n"
+                 "\n\t--instrument\tcount and time the calls of every "
+                 "function,\n\t\t\tprinting a profile when the program "
+                 "exits\n"
+                 "\n\t--profile-generate[=sailfish.profile]\n\t\t\tcount "
+                 "how often each Tree branch is\n\t\t\ttaken, adding the "
+                 "counts to the profile\n\t\t\twhen the program exits\n"
+                 "\n\t--profile-use[=sailfish.profile]\n\t\t\torder and "
+                 "hint Tree branches by how\n\t\t\toften the profile saw "
+                 "them taken\n"
+                 "\n\t--sample[=FILE]\n\t\t\tsample the call stack "
+                 "every millisecond\n\t\t\tof CPU time, writing folded "
+                 "stacks to\n\t\t\tsailfish.folded or the file given\n"
+                 "\n\t--stats\t\tprint token, symbol, output and heap "
+                 "counts\n\t\t\tand the peak resident memory\n"
+                 "\n\t--time-report[=trace.json]\n\t\t\tprint the wall and CPU "
+                 "time of each compile\n\t\t\tphase per file, and write them "
+                 "as Chrome\n\t\t\ttrace events if given a file\n"
               << normal;
 }
 
@@ -38,7 +80,7 @@ versionInfo()
 }
 
 bool
-compileC()
+compileC(const CompilerOptions& options)
 {
     // check to see if we can use system
     if (!system(NULL))
@@ -48,8 +90,18 @@ compileC()
         return false;
     }
 
-    std::cout << "EXECUTING: gcc out.c\n";
-    system("gcc out.c");
+    // -lm for pow, which flt ** uses for fractional exponents
+    std::string command = "gcc out.c -lm";
+    if (options.linkRuntime)
+        command += " -I" + std::string(SAILFISH_RUNTIME_DIR) + " " +
+                   std::string(SAILFISH_RUNTIME_DIR) + "/lib" +
+                   stdlib_c_RUNTIME_NAME + ".a";
+
+    std::cout << "EXECUTING: " << command << "\n";
+    {
+        TimeScope scope("gcc", "out.c");
+        system(command.c_str());
+    }
 
     std::cout << "gcc compiled out.c to: a.out\n";
 
@@ -64,7 +116,23 @@ executeBinary()
 }
 
 bool
-fullCompilation(const std::string& filename)
+emitRuntime(const std::string& directory)
+{
+    std::ofstream header(directory + "/" + stdlib_c_RUNTIME_NAME + ".h");
+    std::ofstream source(directory + "/" + stdlib_c_RUNTIME_NAME + ".c");
+    if (!header.good() || !source.good())
+    {
+        std::cerr << "Unable to write the runtime to: " << directory << "\n";
+        return false;
+    }
+
+    header << getStdLibCHeaderFile();
+    source << getStdLibCSourceFile();
+    return true;
+}
+
+bool
+fullCompilation(const std::string& filename, const CompilerOptions& options)
 {
     try
     {
@@ -79,13 +147,36 @@ fullCompilation(const std::string& filename)
 
         std::cout << "Compiling " << blue << filename << normal << ".\n";
 
-        sailfishc* sfc = new sailfishc(filename, true);
-        sfc->parse();
+        {
+            TimeScope scope("compile", filename);
+            sailfishc* sfc = new sailfishc(filename, true, options);
+            sfc->parse();
+        }
 
         std::cout << green << "Successfully compiled: " << normal << blue
                   << filename << "\n"
                   << normal;
 
+        auto stats = compileStats();
+        if (stats.foldedExpressions > 0 || stats.prunedBranches > 0)
+            std::cout << "Folded " << stats.foldedExpressions
+                      << " constant expressions and pruned "
+                      << stats.prunedBranches << " Tree branches.\n";
+        if (stats.switchTrees > 0)
+            std::cout << "Generated " << stats.switchTrees
+                      << " Trees as switch statements.\n";
+        if (stats.cachedCalls > 0)
+            std::cout << "Cached " << stats.cachedCalls
+                      << " repeated pure calls in Tree guards.\n";
+        if (stats.reorderedTrees > 0 || stats.hintedBranches > 0)
+            std::cout << "Reordered " << stats.reorderedTrees
+                      << " Trees and hinted " << stats.hintedBranches
+                      << " Tree branches by the branch profile.\n";
+
+        // a new build starts a new profile
+        if (options.profileGenerateFile != "")
+            std::ofstream(options.profileGenerateFile, std::ios::trunc);
+
         std::cout << green << "Successfully wrote compiled code to: " << normal
                   << blue << " out.c\n"
                   << normal;
@@ -103,62 +194,200 @@ fullCompilation(const std::string& filename)
     }
 }
 
+// checks the program as a compile would, then lowers it to bytecode and runs
+// it in-process instead of writing out.c, returning the program's status
 int
-handleCommandLine(int argc, char* const* argv)
+runProgram(const std::string& filename, const CompilerOptions& options)
 {
-    switch (argc)
+    // the checker reports errors on cout, which belongs to the program here
+    std::ostringstream report;
+    auto coutBuffer = std::cout.rdbuf(report.rdbuf());
+    try
     {
-    case 1:
+        TimeScope scope("check", filename);
+        auto checkOptions = options;
+        checkOptions.writeOutput = false;
+        sailfishc sfc(filename, true, checkOptions);
+        sfc.parse();
+    }
+    catch (const std::string msg)
+    {
+        std::cout.rdbuf(coutBuffer);
+        std::cerr << report.str() << msg;
+        return 1;
+    }
+    catch (char const* msg)
+    {
+        std::cout.rdbuf(coutBuffer);
+        std::cerr << report.str() << msg;
+        return 1;
+    }
+    std::cout.rdbuf(coutBuffer);
+
+    Program program;
+    try
+    {
+        TimeScope scope("lower", filename);
+        program = BytecodeCompiler().compile(filename);
+    }
+    catch (const std::string msg)
+    {
+        std::cerr << msg;
+        return 1;
+    }
+
+    TimeScope scope("run", filename);
+    VM vm(program, options.lineBuffered || isatty(fileno(stdout)));
+    return vm.run();
+}
+
+// what the compiler read, built, wrote and allocated, for finding out where a
+// large input spends memory
+void
+printStats(std::ostream& out)
+{
+    auto stats = compileStats();
+    auto heap = heapStats();
+
+    rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+
+    long tokens = 0;
+    for (auto const& kind : stats.tokens)
+        tokens += kind.second;
+
+    out << "Stats:\n"
+        << "  bytes lexed            " << stats.bytesLexed << "\n"
+        << "  tokens                 " << tokens << "\n";
+    for (auto const& kind : stats.tokens)
+        out << "    " << std::left << std::setw(20) << kind.first << " "
+            << std::right << kind.second << "\n";
+    out << "  symbols inserted       " << stats.symbolsInserted << "\n"
+        << "  scopes entered         " << stats.scopesEntered << "\n"
+        << "  scope entries copied   " << stats.localCacheCopies << "\n"
+        << "  UDTs registered        " << stats.udtsRegistered << "\n"
+        << "  errors created         " << stats.errorsCreated << "\n"
+        << "  bytes emitted          " << stats.bytesEmitted << "\n"
+        << "  heap allocations       " << heap.allocations << "\n"
+        << "  heap frees             " << heap.frees << "\n"
+        << "  heap bytes allocated   " << heap.bytes << "\n"
+        << "  peak resident KB       " << usage.ru_maxrss << "\n";
+}
+
+// pulls the code generation and reporting flags out of argv, returning the
+// command and its arguments in order
+std::vector<std::string>
+parseOptions(int argc, char* const* argv, CompilerOptions& options,
+             bool& showStats, std::string& profileUse)
+{
+    std::vector<std::string> args;
+    for (int i = 1; i < argc; i++)
+    {
+        std::string arg = argv[i];
+        if (arg == "--link_runtime")
+            options.linkRuntime = true;
+        else if (arg == "--line_buffered")
+            options.lineBuffered = true;
+        else if (arg == "--arena")
+            options.arenaAllocation = true;
+        else if (arg == "--inline")
+            options.inlineCalls = true;
+        else if (arg == "--line_directives")
+            options.lineDirectives = true;
+        else if (arg == "--instrument")
+            options.instrument = true;
+        else if (arg == "--profile-generate")
+            options.profileGenerateFile = "sailfish.profile";
+        else if (arg.rfind("--profile-generate=", 0) == 0)
+            options.profileGenerateFile =
+                arg.substr(std::string("--profile-generate=").size());
+        else if (arg == "--profile-use")
+            profileUse = "sailfish.profile";
+        else if (arg.rfind("--profile-use=", 0) == 0)
+            profileUse = arg.substr(std::string("--profile-use=").size());
+        else if (arg == "--sample")
+            options.sampleFile = "sailfish.folded";
+        else if (arg.rfind("--sample=", 0) == 0)
+            options.sampleFile = arg.substr(std::string("--sample=").size());
+        else if (arg == "--stats")
+            showStats = true;
+        else if (arg == "--time-report")
+            timeReport().enable("");
+        else if (arg.rfind("--time-report=", 0) == 0)
+            timeReport().enable(
+                arg.substr(std::string("--time-report=").size()));
+        else
+            args.push_back(arg);
+    }
+
+    return args;
+}
+
+int
+runCommand(const std::vector<std::string>& args,
+           const CompilerOptions& options)
+{
+    switch (args.size())
+    {
+    case 0:
         helpMessage();
         return 0;
 
-    case 2:
+    case 1:
     {
-        if (std::string("--help").compare(argv[1]) == 0)
+        if (args[0] == "--help")
         {
             helpMessage();
         }
-        else if (std::string("--version").compare(argv[1]) == 0)
+        else if (args[0] == "--version")
         {
             versionInfo();
         }
         else
         {
-            fullCompilation(argv[1]);
+            fullCompilation(args[0], options);
         }
 
         return 0;
     }
-    case 3:
+    case 2:
     {
-        if (std::string("--test").compare(argv[1]) == 0)
+        if (args[0] == "--test")
         {
             Prettify::Formatter red(Prettify::FG_RED);
             Prettify::Formatter green(Prettify::FG_GREEN);
             Prettify::Formatter normal(Prettify::RESET);
 
-            bool result = SEMANTIC_ANALYSIS_TEST(argv[2]);
+            bool result = SEMANTIC_ANALYSIS_TEST(args[1]);
             if (result)
                 std::cout << green << "SUCCESSFUL TEST!" << '\n' << normal;
             else
                 std::cout << red << "TEST FAILED!" << '\n' << normal;
         }
-        else if (std::string("--compile_c").compare(argv[1]) == 0)
+        else if (args[0] == "--emit_runtime")
+        {
+            return emitRuntime(args[1]) ? 0 : 1;
+        }
+        else if (args[0] == "--run")
+        {
+            return runProgram(args[1], options);
+        }
+        else if (args[0] == "--compile_c")
         {
             // compile sailfish
-            if (fullCompilation(argv[2]))
+            if (fullCompilation(args[1], options))
             {
                 // compile c
-                compileC();
+                compileC(options);
             }
         }
-        else if (std::string("--compile_and_execute").compare(argv[1]) == 0)
+        else if (args[0] == "--compile_and_execute")
         {
             // compile sailfish
-            if (fullCompilation(argv[2]))
+            if (fullCompilation(args[1], options))
             {
                 // compile c
-                if (compileC())
+                if (compileC(options))
                 {
                     // execute gcc generated binary
                     executeBinary();
@@ -178,4 +407,30 @@ handleCommandLine(int argc, char* const* argv)
                   << " to see command options !\n ";
         return 0;
     }
+
+    return 0;
+}
+
+int
+handleCommandLine(int argc, char* const* argv)
+{
+    CompilerOptions options;
+    bool showStats = false;
+    std::string profileUse;
+    auto args = parseOptions(argc, argv, options, showStats, profileUse);
+
+    if (profileUse != "" && !branchProfile().load(profileUse))
+    {
+        std::cerr << "Unable to read the branch profile: " << profileUse
+                  << "\n";
+        return 1;
+    }
+
+    auto status = runCommand(args, options);
+    if (showStats)
+        printStats(std::cout);
+    if (timeReport().isEnabled())
+        timeReport().report(std::cout);
+
+    return status;
 }
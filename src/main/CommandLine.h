@@ -5,6 +5,7 @@
  * CommandLine handles the basic command line utilities for the compiler.
  */
 #pragma once
+#include "../common/HeapStats.h"
 #include "../common/display.h"
 #include "../lexar/Lexar.h"
 #include "../sailfish/sailfishc.h"
@@ -13,4 +14,9 @@
 #include <stdlib.h>
 #include <string>
 
+// where the build put the precompiled runtime library, see CMakeLists.txt
+#ifndef SAILFISH_RUNTIME_DIR
+#define SAILFISH_RUNTIME_DIR "runtime"
+#endif
+
 int handleCommandLine(int, char* const* argv);
\ No newline at end of file
@@ -35,15 +35,17 @@ builtinTypesTranslator(std::string type)
 }
 
 UdtFlagAndBufer
-parseFile(const std::string& filename, bool shouldDisplayErrors)
+parseFile(const std::string& filename, bool shouldDisplayErrors,
+          const CompilerOptions& options)
 {
     try
     {
-        sailfishc* sfc = new sailfishc(filename, shouldDisplayErrors);
+        sailfishc* sfc = new sailfishc(filename, shouldDisplayErrors, options);
         sfc->parse();
+        auto transpiler = sfc->getTranspiler();
         return std::make_tuple(std::move(sfc->getUDTTable()),
-                               sfc->getIsUDTFlag(),
-                               sfc->getTranspiler()->getBuffer());
+                               sfc->getIsUDTFlag(), transpiler->getBuffer(),
+                               transpiler->getInlineBodies());
     }
     catch (const std::string msg)
     {
@@ -65,6 +67,183 @@ extractUDTName(const std::string& s)
     return s.substr(front, back);
 }
 
+// splits a guard of the form 'x op k', in either order, where op compares and
+// k is an int literal, failing for anything else at the top level of the
+// guard; op is as if k were on the right
+bool
+splitComparison(const std::string& guard, std::string& scrutinee,
+                std::string& op, std::string& constant)
+{
+    int depth = 0;
+    bool inString = false;
+    size_t comparison = std::string::npos;
+    for (size_t i = 0; i < guard.size(); ++i)
+    {
+        auto c = guard[i];
+        if (inString)
+        {
+            if (c == '\\')
+                ++i;
+            else if (c == '"')
+                inString = false;
+            continue;
+        }
+
+        if (c == '"')
+            inString = true;
+        else if (c == '(' || c == '[')
+            ++depth;
+        else if (c == ')' || c == ']')
+            --depth;
+        else if (depth == 0 && (guard.compare(i, 2, "==") == 0 ||
+                                guard.compare(i, 2, "<=") == 0 ||
+                                guard.compare(i, 2, ">=") == 0))
+        {
+            if (comparison != std::string::npos)
+                return false;
+            op = guard.substr(i, 2);
+            comparison = i++;
+        }
+        // an arrow is attribute access, not greater than
+        else if (depth == 0 &&
+                 (c == '<' || (c == '>' && (i == 0 || guard[i - 1] != '-'))))
+        {
+            if (comparison != std::string::npos)
+                return false;
+            op = c;
+            comparison = i;
+        }
+        // anything binding looser than == would make it a partial operand
+        else if (depth == 0 && std::string("=!&|?,").find(c) !=
+                                   std::string::npos)
+            return false;
+    }
+
+    if (comparison == std::string::npos)
+        return false;
+
+    auto trim = [](const std::string& s) {
+        auto front = s.find_first_not_of(' ');
+        auto back = s.find_last_not_of(' ');
+        return front == std::string::npos ? ""
+                                          : s.substr(front, back - front + 1);
+    };
+    auto isIntLiteral = [](const std::string& s) {
+        auto digits = s;
+        if (s.size() > 3 && s.compare(0, 2, "(-") == 0 && s.back() == ')')
+            digits = s.substr(2, s.size() - 3);
+        return !digits.empty() &&
+               digits.find_first_not_of("0123456789") == std::string::npos;
+    };
+
+    auto left = trim(guard.substr(0, comparison));
+    auto right = trim(guard.substr(comparison + op.size()));
+    if (isIntLiteral(right) && !isIntLiteral(left) && left != "")
+    {
+        scrutinee = left;
+        constant = right;
+        return true;
+    }
+    if (isIntLiteral(left) && !isIntLiteral(right) && right != "")
+    {
+        scrutinee = right;
+        constant = left;
+        std::map<std::string, std::string> flipped = {
+            {"==", "=="}, {"<", ">"}, {"<=", ">="}, {">", "<"}, {">=", "<="}};
+        op = flipped[op];
+        return true;
+    }
+    return false;
+}
+
+// splits a guard of the form 'x == k', in either order, where k is an int
+// literal
+bool
+splitEquality(const std::string& guard, std::string& scrutinee,
+              std::string& constant)
+{
+    std::string op;
+    return splitComparison(guard, scrutinee, op, constant) && op == "==";
+}
+
+// the value of an int literal as written by the transpiler, negatives in
+// parentheses
+long
+intLiteral(const std::string& constant)
+{
+    return std::stol(constant[0] == '('
+                         ? constant.substr(1, constant.size() - 2)
+                         : constant);
+}
+
+// the newline and indentation of a Tree, from the text of its first block
+std::string
+treeIndentation(const std::string& block)
+{
+    return block.substr(0, block.find('{'));
+}
+
+bool
+isIdentifierChar(char c)
+{
+    return std::isalnum(c) || c == '_';
+}
+
+// where call is first made in text, not counting calls to functions whose
+// name merely ends with the same name
+size_t
+findCall(const std::string& text, const std::string& call, size_t from = 0)
+{
+    auto at = text.find(call, from);
+    while (at != std::string::npos && at > 0 && isIdentifierChar(text[at - 1]))
+        at = text.find(call, at + 1);
+    return at;
+}
+
+// replaces every call in text with name, returning how many there were
+int
+replaceCalls(std::string& text, const std::string& call,
+             const std::string& name)
+{
+    int count = 0;
+    for (auto at = findCall(text, call); at != std::string::npos;
+         at = findCall(text, call, at + name.size()))
+    {
+        text.replace(at, call.size(), name);
+        ++count;
+    }
+    return count;
+}
+
+// whether anything following prefix in a guard may not be evaluated
+bool
+isConditional(const std::string& prefix)
+{
+    return prefix.find("&&") != std::string::npos ||
+           prefix.find("||") != std::string::npos ||
+           prefix.find('?') != std::string::npos;
+}
+
+// whether a declaration shadows a variable the call reads, in which case the
+// call there is a different one
+bool
+declares(const std::string& declaration, const std::string& call)
+{
+    auto end = declaration.find(" = ");
+    auto start = end;
+    while (start > 0 && isIdentifierChar(declaration[start - 1]))
+        --start;
+    auto name = declaration.substr(start, end - start);
+
+    for (auto at = call.find(name); at != std::string::npos;
+         at = call.find(name, at + 1))
+        if ((at == 0 || !isIdentifierChar(call[at - 1])) &&
+            (at + name.size() == call.size() ||
+             !isIdentifierChar(call[at + name.size()])))
+            return true;
+    return false;
+}
+
 // -------- Parser Helper Code --------- //
 
 std::string
@@ -90,6 +269,7 @@ sailfishc::advanceAndCheckToken(const TokenKind& k)
 void
 sailfishc::advanceToken()
 {
+    TimeTally tally("lex", filename);
     currentToken = lexar->getNextToken();
 
     // catch errors from the lexar
@@ -112,6 +292,428 @@ sailfishc::advanceToken()
 }
 
 // -------- Semantic Analysis Helper Code --------- //
+// replaces part of the transpiled code, keeping the recorded tail calls
+// pointing at the same code
+void
+sailfishc::rewriteBuffer(int from, int to, const std::string& text)
+{
+    auto shift = (int)text.size() - (to - from);
+    for (auto spans : {&tailCalls, &returnTailCalls})
+    {
+        std::vector<std::tuple<int, int>> kept;
+        for (auto const& span : *spans)
+        {
+            if (std::get<1>(span) <= from)
+                kept.push_back(span);
+            else if (std::get<0>(span) >= to)
+                kept.push_back(std::make_tuple(std::get<0>(span) + shift,
+                                               std::get<1>(span) + shift));
+        }
+        *spans = kept;
+    }
+
+    transpiler->replace(from, to, text);
+}
+
+// rewrites a Tree whose guards all compare the same int expression with
+// distinct int literals into a switch, which C compilers can turn into a jump
+// table and which evaluates the expression once; a final always true branch
+// becomes the default
+bool
+sailfishc::lowerTreeToSwitch(const std::vector<TreeBranch>& branches)
+{
+    auto buffer = transpiler->getBuffer();
+    std::string scrutinee;
+    std::vector<std::string> labels;
+    std::set<long> seen;
+    for (auto const& branch : branches)
+    {
+        auto header =
+            buffer.substr(branch.start, branch.blockStart - branch.start);
+        auto open = header.find('(');
+        if (open == std::string::npos)
+        {
+            // only the last branch can be unconditional
+            labels.push_back("default");
+            continue;
+        }
+
+        std::string s;
+        std::string constant;
+        auto guard = header.substr(open + 1, header.rfind(')') - open - 1);
+        if (!splitEquality(guard, s, constant) ||
+            (scrutinee != "" && s != scrutinee))
+            return false;
+
+        if (!seen.insert(intLiteral(constant)).second)
+            return false;
+
+        scrutinee = s;
+        labels.push_back("case " + constant);
+    }
+
+    if ((int)seen.size() < SWITCH_MIN_CASES)
+        return false;
+
+    // rewrite from the back so the earlier positions stay valid
+    auto tabs = treeIndentation(buffer.substr(
+        branches.front().blockStart,
+        branches.front().blockEnd - branches.front().blockStart));
+    auto end = branches.back().blockEnd;
+    rewriteBuffer(end, end, tabs + "break;" + tabs + "}");
+    for (int i = branches.size() - 1; i >= 0; --i)
+    {
+        auto label = tabs + labels[i] + ":";
+        rewriteBuffer(branches[i].start, branches[i].blockStart,
+                      i == 0 ? "switch (" + scrutinee + ")" + tabs + "{" + label
+                             : tabs + "break;" + label);
+    }
+
+    ++compileStats().switchTrees;
+    return true;
+}
+
+// whether at most one of the guards can hold, each comparing the same int
+// expression with a literal over ranges which do not overlap
+bool
+areExclusive(const std::vector<std::string>& guards)
+{
+    std::string scrutinee;
+    std::vector<std::tuple<long, long>> ranges;
+    for (auto const& guard : guards)
+    {
+        std::string s;
+        std::string op;
+        std::string constant;
+        if (!splitComparison(guard, s, op, constant) ||
+            (scrutinee != "" && s != scrutinee))
+            return false;
+        scrutinee = s;
+
+        auto k = intLiteral(constant);
+        auto low = std::numeric_limits<long>::min();
+        auto high = std::numeric_limits<long>::max();
+        if (op == "==")
+            low = high = k;
+        else if (op == "<")
+            high = k - 1;
+        else if (op == "<=")
+            high = k;
+        else if (op == ">")
+            low = k + 1;
+        else
+            low = k;
+        ranges.push_back(std::make_tuple(low, high));
+    }
+
+    std::sort(ranges.begin(), ranges.end());
+    for (size_t i = 1; i < ranges.size(); ++i)
+        if (std::get<0>(ranges[i]) <= std::get<1>(ranges[i - 1]))
+            return false;
+    return true;
+}
+
+// orders and hints a Tree's branches by how often the profile read with
+// --profile-use saw them taken
+void
+sailfishc::applyBranchProfile(std::vector<TreeBranch>& branches, int line,
+                              int column)
+{
+    if (!branchProfile().hasTree(filename, line, column))
+        return;
+
+    std::vector<long> counts;
+    long taken = 0;
+    for (auto const& branch : branches)
+    {
+        counts.push_back(
+            branchProfile().getCount(filename, line, column, branch.index));
+        taken += counts.back();
+    }
+    auto reached =
+        std::max(branchProfile().getCount(filename, line, column, 0), taken);
+
+    reorderTreeBranches(branches, counts);
+    hintTreeBranches(branches, counts, reached);
+}
+
+// when the guards are free of side effects and at most one of them can hold,
+// the order they are tested in only changes how many are tested, so the most
+// taken branches are moved first. Each guard moves with its block, leaving
+// the 'if' and 'else if's where they were, and a final unconditional branch
+// stays last.
+bool
+sailfishc::reorderTreeBranches(std::vector<TreeBranch>& branches,
+                               std::vector<long>& counts)
+{
+    size_t conditional = branches.size();
+    std::vector<int> opens;
+    std::vector<std::string> guards;
+    for (size_t i = 0; i < branches.size(); ++i)
+    {
+        auto header = transpiler->getText(branches[i].start,
+                                          branches[i].blockStart);
+        auto open = header.find('(');
+        if (open == std::string::npos)
+        {
+            conditional = i;
+            break;
+        }
+        if (!branches[i].isGuardPure)
+            return false;
+
+        opens.push_back(branches[i].start + open);
+        guards.push_back(header.substr(open + 1, header.rfind(')') - open - 1));
+    }
+
+    if (conditional < 2 || !areExclusive(guards))
+        return false;
+
+    std::vector<size_t> order;
+    for (size_t i = 0; i < conditional; ++i)
+        order.push_back(i);
+    std::stable_sort(order.begin(), order.end(), [&counts](size_t a, size_t b) {
+        return counts[a] > counts[b];
+    });
+    if (std::is_sorted(order.begin(), order.end()))
+        return false;
+
+    // the text is the same length once reordered, so only what moved shifts
+    auto from = branches.front().start;
+    std::string text;
+    std::vector<int> starts;
+    std::vector<int> shifts(conditional);
+    for (size_t k = 0; k < conditional; ++k)
+    {
+        auto moved = order[k];
+        starts.push_back(from + text.size());
+        text += transpiler->getText(branches[k].start, opens[k]);
+        shifts[moved] = from + text.size() - opens[moved];
+        text += transpiler->getText(opens[moved], branches[moved].blockEnd);
+    }
+
+    for (auto spans : {&tailCalls, &returnTailCalls})
+        for (auto& span : *spans)
+            for (size_t i = 0; i < conditional; ++i)
+                if (std::get<0>(span) >= opens[i] &&
+                    std::get<1>(span) <= branches[i].blockEnd)
+                {
+                    span = std::make_tuple(std::get<0>(span) + shifts[i],
+                                           std::get<1>(span) + shifts[i]);
+                    break;
+                }
+
+    transpiler->replace(from, branches[conditional - 1].blockEnd, text);
+
+    std::vector<TreeBranch> reordered;
+    std::vector<long> reorderedCounts;
+    for (size_t k = 0; k < branches.size(); ++k)
+    {
+        auto i = k < conditional ? order[k] : k;
+        auto branch = branches[i];
+        if (k < conditional)
+        {
+            branch.start = starts[k];
+            branch.blockStart += shifts[i];
+            branch.blockEnd += shifts[i];
+            if (branch.leadStart != -1)
+            {
+                branch.leadStart += shifts[i];
+                branch.leadEnd += shifts[i];
+            }
+        }
+        reordered.push_back(branch);
+        reorderedCounts.push_back(counts[i]);
+    }
+    branches = reordered;
+    counts = reorderedCounts;
+
+    ++compileStats().reorderedTrees;
+    return true;
+}
+
+// a guard's odds are the times its branch was taken over the times it was
+// tested, which is the times the Tree was reached less the times an earlier
+// branch was taken
+void
+sailfishc::hintTreeBranches(std::vector<TreeBranch>& branches,
+                            const std::vector<long>& counts, long reached)
+{
+    std::vector<std::string> hints;
+    auto tested = reached;
+    for (auto count : counts)
+    {
+        std::string hint;
+        if (tested > 0 && count >= LIKELY_BRANCH * tested)
+            hint = "1";
+        else if (tested > 0 && count <= UNLIKELY_BRANCH * tested)
+            hint = "0";
+        hints.push_back(hint);
+        tested -= count;
+    }
+
+    // rewrite from the back so the earlier positions stay valid
+    for (int i = branches.size() - 1; i >= 0; --i)
+    {
+        auto header = transpiler->getText(branches[i].start,
+                                          branches[i].blockStart);
+        auto open = header.find('(');
+        if (hints[i] == "" || open == std::string::npos)
+            continue;
+
+        auto close = header.rfind(')');
+        auto guard = header.substr(open + 1, close - open - 1);
+        auto hinted = "__builtin_expect(!!(" + guard + "), " + hints[i] + ")";
+        rewriteBuffer(branches[i].start + open + 1, branches[i].start + close,
+                      hinted);
+
+        int shift = hinted.size() - guard.size();
+        for (size_t j = i; j < branches.size(); ++j)
+        {
+            if (j > (size_t)i)
+                branches[j].start += shift;
+            branches[j].blockStart += shift;
+            branches[j].blockEnd += shift;
+            if (branches[j].leadStart != -1)
+            {
+                branches[j].leadStart += shift;
+                branches[j].leadEnd += shift;
+            }
+        }
+        ++compileStats().hintedBranches;
+    }
+}
+
+// a pure call's value is cached in a temporary when it is made again by a
+// later guard of the same Tree, or by the leading declaration of a branch
+// whose guard comes after it. The first call assigns the temporary where it
+// was, so that calls behind a guard still only run once the guard is reached.
+// Every guard must be free of side effects and assignments, so nothing can
+// change between the calls.
+void
+sailfishc::addPureCall(const std::string& output, int start)
+{
+    if (output == "int" || output == "flt" || output == "bool" ||
+        output == "str")
+        guardCalls.push_back(std::make_tuple(
+            transpiler->getText(start, transpiler->getPosition()),
+            builtinTypesTranslator(output)));
+}
+
+// an assignment through a UDT is seen outside of the function
+void
+sailfishc::countAssignment(int target)
+{
+    ++assignments;
+    if (transpiler->getText(target, transpiler->getPosition()).find("->") !=
+        std::string::npos)
+        ++sideEffects;
+}
+
+void
+sailfishc::cachePureCalls(const std::vector<TreeBranch>& branches)
+{
+    // the texts which may be rewritten: each guard, then each branch's
+    // leading declaration, in buffer order
+    std::vector<std::tuple<int, int, std::string>> spans;
+    std::vector<int> guards;
+    std::vector<int> leads;
+    std::vector<std::tuple<std::string, std::string>> calls;
+    for (auto const& branch : branches)
+    {
+        auto header = transpiler->getText(branch.start, branch.blockStart);
+        auto open = header.find('(');
+        if (open != std::string::npos && !branch.isGuardPure)
+            return;
+
+        guards.push_back(-1);
+        if (open != std::string::npos)
+        {
+            auto from = branch.start + (int)open + 1;
+            auto to = branch.start + (int)header.rfind(')');
+            guards.back() = spans.size();
+            spans.push_back(
+                std::make_tuple(from, to, transpiler->getText(from, to)));
+            calls.insert(calls.end(), branch.guardCalls.begin(),
+                         branch.guardCalls.end());
+        }
+
+        leads.push_back(-1);
+        if (branch.leadStart != -1)
+        {
+            leads.back() = spans.size();
+            spans.push_back(std::make_tuple(
+                branch.leadStart, branch.leadEnd,
+                transpiler->getText(branch.leadStart, branch.leadEnd)));
+        }
+    }
+
+    // enclosing calls first, so a call nested in one is cached only if it is
+    // also made on its own
+    std::stable_sort(calls.begin(), calls.end(),
+                     [](auto const& a, auto const& b) {
+                         return std::get<0>(a).size() > std::get<0>(b).size();
+                     });
+
+    auto tabs = treeIndentation(transpiler->getText(
+        branches.front().blockStart, branches.front().blockEnd));
+    std::string declarations;
+    std::set<std::string> seen;
+    for (auto const& call : calls)
+    {
+        auto text = std::get<0>(call);
+        if (!seen.insert(text).second)
+            continue;
+
+        // the first guard which always makes the call
+        int first = 0;
+        size_t at = std::string::npos;
+        for (; first < (int)branches.size(); ++first)
+        {
+            if (guards[first] == -1)
+                continue;
+            auto const& guard = std::get<2>(spans[guards[first]]);
+            at = findCall(guard, text);
+            if (at != std::string::npos && !isConditional(guard.substr(0, at)))
+                break;
+            at = std::string::npos;
+        }
+
+        if (at == std::string::npos)
+            continue;
+
+        auto name = "cse_" + std::to_string(cachedCalls);
+        int uses = 0;
+        for (int i = first; i < (int)branches.size(); ++i)
+        {
+            if (i > first && guards[i] != -1)
+                uses += replaceCalls(std::get<2>(spans[guards[i]]), text, name);
+
+            if (leads[i] != -1 &&
+                !declares(std::get<2>(spans[leads[i]]), text))
+                uses += replaceCalls(std::get<2>(spans[leads[i]]), text, name);
+        }
+
+        if (uses == 0)
+            continue;
+
+        std::get<2>(spans[guards[first]])
+            .replace(at, text.size(), "(" + name + " = " + text + ")");
+        declarations += std::get<1>(call) + " " + name + ";" + tabs;
+        ++cachedCalls;
+        ++compileStats().cachedCalls;
+    }
+
+    if (declarations == "")
+        return;
+
+    for (int i = spans.size() - 1; i >= 0; --i)
+        rewriteBuffer(std::get<0>(spans[i]), std::get<1>(spans[i]),
+                      std::get<2>(spans[i]));
+    rewriteBuffer(branches.front().start, branches.front().start,
+                  declarations);
+}
+
 void
 sailfishc::checkType(const std::string& t0, const std::string& t1)
 {
@@ -289,7 +891,8 @@ sailfishc::checkFunctionCall(const std::string& name,
             if (right.at(0) == '[')
                 right = extractListType(right);
 
-            if (left != right)
+            // generic list builtins such as len take [any]
+            if (left != right && left != "any")
             {
                 semanticerrorhandler->handle(std::make_unique<Error>(Error(
                     currentToken->col, currentToken->line,
@@ -372,7 +975,8 @@ containsUDT(const std::string& filename)
 }
 
 // constructor
-sailfishc::sailfishc(const std::string& file, bool sde)
+sailfishc::sailfishc(const std::string& file, bool sde,
+                     const CompilerOptions& opts)
 {
     filename = file;
     lexar = std::make_unique<Lexar>(file, true);
@@ -384,13 +988,21 @@ sailfishc::sailfishc(const std::string& file, bool sde)
     udttable = std::make_unique<UDTTable>(UDTTable());
     isUdt = false;
     shouldDisplayErrors = sde;
-    transpiler = std::make_unique<Transpiler>(Transpiler());
+    options = opts;
+    transpiler = std::make_unique<Transpiler>(Transpiler(options));
+    isPartialOperand = false;
+    expressionConstant = "";
+    sideEffects = 0;
+    assignments = 0;
+    leadingDeclaration = std::make_tuple(-1, -1);
+    cachedCalls = 0;
 }
 
 // public interface method
 void
 sailfishc::parse()
 {
+    TimeScope scope("parse", filename);
     parseProgram();
 }
 
@@ -410,8 +1022,11 @@ sailfishc::parseProgram()
 void
 sailfishc::parseSource()
 {
-    if (containsUDT(filename))
-        isUdt = true;
+    {
+        TimeScope scope("prescan", filename);
+        if (containsUDT(filename))
+            isUdt = true;
+    }
 
     if (!isUdt)
         recursiveParse(false, TokenKind::IMPORT,
@@ -450,11 +1065,16 @@ sailfishc::parseImportInfo()
     std::cout << "Compiling import: " << blue << file << normal << ".\n";
     try
     {
-        auto udtFlagAndBufer = parseFile(file, shouldDisplayErrors);
+        UdtFlagAndBufer udtFlagAndBufer;
+        {
+            TimeScope scope("import", file);
+            udtFlagAndBufer = parseFile(file, shouldDisplayErrors, options);
+        }
 
         auto table = std::move(std::get<0>(udtFlagAndBufer));
         auto flag = std::get<1>(udtFlagAndBufer);
         auto buf = std::get<2>(udtFlagAndBufer);
+        auto inlineBodies = std::get<3>(udtFlagAndBufer);
 
         if (!flag)
             errorhandler->handle(std::make_unique<Error>(
@@ -481,6 +1101,7 @@ sailfishc::parseImportInfo()
 
         // aggregate udt buffers
         transpiler->append(buf);
+        transpiler->addInlineBodies(inlineBodies);
 
         std::cout << green << "Successfully compiled import: " << normal << blue
                   << file << "\n"
@@ -528,7 +1149,10 @@ sailfishc::parseSourcePart()
 
         // don't write to out.c if we are testing, aka we don' care about errors
         if (shouldDisplayErrors)
+        {
+            TimeScope scope("write", filename);
             transpiler->write(semanticerrorhandler->getErrors().size() == 0);
+        }
     }
 }
 
@@ -560,6 +1184,7 @@ sailfishc::parseUserDefinedType()
 
     transpiler->genRightCurley();
     transpiler->genSemiColonAndNewline();
+    transpiler->genUDTPool(udtname);
 
     this->parseMethods(m_st);
 
@@ -690,6 +1315,7 @@ sailfishc::parseScript()
 void
 sailfishc::parseFunctionDefinition()
 {
+    auto line = currentToken->line;
     advanceAndCheckToken(TokenKind::LPAREN); // consume l paren
     advanceAndCheckToken(TokenKind::FUN);    // consume fun
 
@@ -697,7 +1323,7 @@ sailfishc::parseFunctionDefinition()
     auto id = parseIdentifier();
 
     // parse right child
-    parseFunctionInfo(id);
+    parseFunctionInfo(id, line);
 
     advanceAndCheckToken(TokenKind::RPAREN); // consume r paren
 }
@@ -709,7 +1335,7 @@ sailfishc::parseFunctionDefinition()
  *  - actual return type matches expected return type
  */
 void
-sailfishc::parseFunctionInfo(const std::string& name)
+sailfishc::parseFunctionInfo(const std::string& name, int line)
 {
 
     auto type = parseFunctionInOut(name);
@@ -727,13 +1353,30 @@ sailfishc::parseFunctionInfo(const std::string& name)
                   "Received second declaration of type: ", type, ".")));
 
     transpiler->genLeftCurley();
+    transpiler->genProfileEntry(
+        isUdt ? extractUDTName(filename) + "..." + name : name, filename, line);
+    transpiler->genFunctionBodyStart(currentParameters);
+
+    currentFunction = name;
+    currentFunctionOutput = parseFunctionReturnType(type);
+    returnTailCalls.clear();
 
+    auto effects = sideEffects;
     symboltable->enterScope();
     auto returnType = parseBlock();
 
     symboltable->exitScope();
 
-    transpiler->genFunctionEnd();
+    // calling itself does not count, so a recursive function can be pure
+    symboltable->setSymbolPure(name, sideEffects == effects);
+
+    // self calls ending the body, or returned from anywhere, become loops
+    tailCalls.insert(tailCalls.end(), returnTailCalls.begin(),
+                     returnTailCalls.end());
+    transpiler->genTailCalls(name, tailCalls);
+    currentFunction = "";
+
+    transpiler->genFunctionEnd(name);
 
     checkType(returnType, parseFunctionReturnType(type));
 }
@@ -756,6 +1399,7 @@ sailfishc::parseFunctionInOut(const std::string& name)
     bool seenVoid = false;
     int argCount = 0;
     std::string outputBuffer = "";
+    currentParameters.clear();
     recursiveParse(true, TokenKind::RPAREN,
                    [&outputBuffer, &types, &seenVoid, &argCount, this]() {
                        ++argCount;
@@ -769,10 +1413,14 @@ sailfishc::parseFunctionInOut(const std::string& name)
                            outedType = "struct " + outedType + "*";
 
                        if (type != "void")
+                       {
                            if (outputBuffer != "")
                                outputBuffer += ", " + outedType + " " + name;
                            else
                                outputBuffer += outedType + " " + name;
+                           currentParameters.push_back(
+                               std::make_tuple(outedType, name));
+                       }
                        else if (!isUdt)
                        {
                            if (outputBuffer != "")
@@ -819,11 +1467,11 @@ sailfishc::parseFunctionInOut(const std::string& name)
             outputBuffer += ", struct " + extractUDTName(filename) + "* this";
         else
             outputBuffer = "struct " + extractUDTName(filename) + "* this";
+        currentParameters.push_back(std::make_tuple(
+            "struct " + extractUDTName(filename) + "*", "this"));
     }
 
-    outputBuffer = output + "\n" + name + "(" + outputBuffer + ")\n";
-
-    transpiler->append(outputBuffer);
+    transpiler->genFunctionHeader(output, name, outputBuffer);
 
     return types;
 }
@@ -834,9 +1482,11 @@ sailfishc::parseFunctionInOut(const std::string& name)
 void
 sailfishc::parseStart()
 {
+    auto line = currentToken->line;
     advanceAndCheckToken(TokenKind::START);
 
     transpiler->genMainHeader();
+    transpiler->genProfileEntry("start", filename, line);
 
     symboltable->enterScope();
     parseBlock();
@@ -861,9 +1511,23 @@ sailfishc::parseBlock()
     bool hasSeenReturn = false;
     advanceAndCheckToken(TokenKind::LCURLEY); // eat '{'
 
-    recursiveParse(true, TokenKind::RCURLEY, [&type, &hasSeenReturn, this]() {
+    // an empty block has no tail calls
+    tailCalls.clear();
+
+    auto lead = std::make_tuple(-1, -1);
+    bool isFirstStatement = true;
+    recursiveParse(true, TokenKind::RCURLEY, [&type, &hasSeenReturn, &lead,
+                                              &isFirstStatement, this]() {
+        transpiler->genLineDirective(currentToken->line, filename);
+        auto start = transpiler->getPosition();
+        auto effects = sideEffects + assignments;
         auto a = this->parseStatement();
 
+        if (isFirstStatement && std::get<1>(a) == "DEC" &&
+            sideEffects + assignments == effects)
+            lead = std::make_tuple(start, transpiler->getPosition());
+        isFirstStatement = false;
+
         if (std::get<1>(a) == "RETURN")
         {
             if (hasSeenReturn)
@@ -885,11 +1549,14 @@ sailfishc::parseBlock()
     });
     advanceAndCheckToken(TokenKind::RCURLEY); // eat '}'
     transpiler->decrementTabs();
+
+    // set last, after any blocks nested in the statements
+    leadingDeclaration = lead;
     return type;
 }
 
 /**
- * Statement := Tree | Return | Declaration | E0
+ * Statement := Tree | Return | Declaration | Delete | E0
  */
 std::tuple<std::string, std::string>
 sailfishc::parseStatement()
@@ -898,9 +1565,16 @@ sailfishc::parseStatement()
     std::string val = "";
     transpiler->genStatementHeader();
 
+    auto start = transpiler->getPosition();
+    auto isSelfCall = [&start, this](int offset) {
+        return lastSelfCall ==
+               std::make_tuple(start + offset, transpiler->getPosition());
+    };
+
     switch (currentToken->kind)
     {
     case TokenKind::TREE:
+        // tail calls of the branches, set by parseTree
         parseTree();
         type = "tree";
         val = "TREE";
@@ -908,14 +1582,30 @@ sailfishc::parseStatement()
     case TokenKind::RETURN:
         type = parseReturn();
         val = "RETURN";
+        tailCalls.clear();
+        if (isSelfCall(std::string("return ").size()))
+            returnTailCalls.push_back(
+                std::make_tuple(start, transpiler->getPosition()));
         break;
     case TokenKind::DEC:
         type = parseDeclaration();
         val = "DEC";
+        tailCalls.clear();
+        break;
+    case TokenKind::DELETE:
+        parseDelete();
+        type = "void";
+        val = "DELETE";
+        tailCalls.clear();
         break;
     default:
         type = parseE0();
         val = "E0";
+        tailCalls.clear();
+        // a non void function must still reach a return after the call
+        if (isSelfCall(0) && currentFunctionOutput == "void")
+            tailCalls.push_back(
+                std::make_tuple(start, transpiler->getPosition()));
     }
 
     transpiler->genStatementFooter();
@@ -928,44 +1618,118 @@ sailfishc::parseStatement()
 void
 sailfishc::parseTree()
 {
+    auto line = currentToken->line;
+    auto column = currentToken->col;
     advanceAndCheckToken(TokenKind::TREE);   // eat 'tree'
     advanceAndCheckToken(TokenKind::LPAREN); // eat '('
 
-    bool isFirstBranch = true;
+    // branch 0 counts how often the Tree is reached
+    transpiler->genBranchCount(filename, line, column, 0);
 
-    recursiveParse(true, TokenKind::RPAREN, [&isFirstBranch, this]() {
+    bool isFirstBranch = true;
+    bool isDecided = false;
+    int index = 0;
+    std::vector<std::tuple<int, int>> branchTailCalls;
+    std::vector<TreeBranch> branches;
+
+    recursiveParse(true, TokenKind::RPAREN, [&isFirstBranch, &isDecided,
+                                             &index, &branchTailCalls,
+                                             &branches, line, column, this]() {
+        auto branchStart = transpiler->getPosition();
         if (isFirstBranch)
-        {
             transpiler->genIfHeader();
-            isFirstBranch = false;
-        }
         else
             transpiler->genElseHeader();
-        this->parseBranch();
+
+        auto branch = this->parseBranch(line, column, ++index);
+        auto guard = branch.guard;
+        auto blockStart = branch.blockStart;
+
+        // branches after an always true guard and those with an always false
+        // guard never run, so only their semantics are checked
+        if (isDecided || guard == "0")
+        {
+            rewriteBuffer(branchStart, transpiler->getPosition(), "");
+            ++compileStats().prunedBranches;
+            return;
+        }
+
+        // an always true guard leaves a plain block, or the final else
+        if (guard != "")
+        {
+            auto header = branchStart;
+            if (!isFirstBranch)
+                header += transpiler->getBuffer()
+                              .substr(branchStart, blockStart - branchStart)
+                              .find("else") +
+                          std::string("else").size();
+            rewriteBuffer(header, blockStart, "");
+            ++compileStats().prunedBranches;
+            isDecided = true;
+        }
+
+        // rewriting the header moved the block
+        auto shift = transpiler->getPosition() - branch.blockEnd;
+        branch.start = branchStart;
+        branch.blockStart += shift;
+        branch.blockEnd += shift;
+        if (branch.leadStart != -1)
+        {
+            branch.leadStart += shift;
+            branch.leadEnd += shift;
+        }
+        branches.push_back(branch);
+        isFirstBranch = false;
+        branchTailCalls.insert(branchTailCalls.end(), tailCalls.begin(),
+                               tailCalls.end());
     });
 
     advanceAndCheckToken(TokenKind::RPAREN); // eat ')'
+
+    // each branch's tail calls are in tail position if the tree is
+    tailCalls = branchTailCalls;
+
+    if (!lowerTreeToSwitch(branches))
+    {
+        applyBranchProfile(branches, line, column);
+        cachePureCalls(branches);
+    }
 }
 
 /**
  * Branch := '(' Grouping Block')'
+ *
+ * Returns the guard's value if it is constant and where the block begins.
  */
-void
-sailfishc::parseBranch()
+TreeBranch
+sailfishc::parseBranch(int line, int column, int index)
 {
     advanceAndCheckToken(TokenKind::LPAREN); // eat '('
 
-    parseGrouping();
+    TreeBranch branch;
+    branch.index = index;
+    auto effects = sideEffects + assignments;
+    branch.guard = parseGrouping();
+    branch.isGuardPure = sideEffects + assignments == effects;
+    branch.guardCalls = guardCalls;
+    branch.blockStart = transpiler->getPosition();
 
     transpiler->genBranchHeader();
+    transpiler->genBranchCount(filename, line, column, index);
 
     symboltable->enterScope();
     parseBlock();
     symboltable->exitScope();
 
+    branch.leadStart = std::get<0>(leadingDeclaration);
+    branch.leadEnd = std::get<1>(leadingDeclaration);
+
     transpiler->genBranchFooter();
+    branch.blockEnd = transpiler->getPosition();
 
     advanceAndCheckToken(TokenKind::RPAREN); // eat ')'
+
+    return branch;
 }
 
 /**
@@ -974,19 +1738,23 @@ sailfishc::parseBranch()
  * Semantic Check:
  *  - resulting type is a bool
  */
-void
+std::string
 sailfishc::parseGrouping()
 {
     transpiler->genLeftParen();
     advanceAndCheckToken(TokenKind::PIPE); // eat '|'
 
+    guardCalls.clear();
     auto type = parseE0();
+    auto constant = expressionConstant;
 
     checkType("bool", type);
 
     transpiler->genRightParen();
 
     advanceAndCheckToken(TokenKind::PIPE); // eat '|'
+
+    return constant;
 }
 
 /**
@@ -1001,6 +1769,31 @@ sailfishc::parseReturn()
     return parseE0();
 }
 
+/**
+ * Delete := 'delete' Identifier
+ *
+ * Semantic Check:
+ *  - the identifier is an instance of a UDT
+ */
+void
+sailfishc::parseDelete()
+{
+    advanceAndCheckToken(TokenKind::DELETE); // consume 'delete'
+
+    auto name = parseIdentifier();
+    checkExists(name);
+
+    auto type = symboltable->getSymbolType(name);
+    if (!udttable->hasUDT(type))
+        semanticerrorhandler->handle(std::make_unique<Error>(
+            Error(currentToken->col, currentToken->line,
+                  "Only UDT instances can be deleted.", "Received: ", name,
+                  " of type " + type + ".")));
+
+    transpiler->genUDTRelease(type, name);
+    ++sideEffects;
+}
+
 /**
  * Declaration :=  'dec' Variable '=' E0
  *
@@ -1024,6 +1817,7 @@ sailfishc::parseDeclaration()
     else
         outtype = builtinTypesTranslator(outtype);
 
+    auto start = transpiler->getPosition();
     transpiler->genTypeAndName(outtype, name);
     transpiler->genOperator("=");
 
@@ -1040,9 +1834,23 @@ sailfishc::parseDeclaration()
 
     transpiler->setDecName(name);
 
+    // an empty list literal takes its element type from the declaration
+    if (type.at(0) == '[')
+        transpiler->setDecType(extractListType(type));
+
     advanceAndCheckToken(TokenKind::ASSIGNMENT); // consume '='
     auto ta = parseE0();
 
+    // until it is assigned to, the variable can stand for its constant, which
+    // may leave the C variable unused
+    if (expressionConstant != "" && (type == "int" || type == "bool"))
+        symboltable->setSymbolConstant(name, expressionConstant);
+    else if (expressionConstant != "" && type == "flt")
+        symboltable->setSymbolConstant(
+            name, ConstantFolder::toSingle(expressionConstant));
+    if (symboltable->getSymbolConstant(name) != "")
+        transpiler->replace(start, start, "__attribute__((unused)) ");
+
     if (name.at(0) == '[')
         checkType(name, ta);
     else
@@ -1057,31 +1865,77 @@ sailfishc::parseDeclaration()
 std::string
 sailfishc::parseE0()
 {
+    auto isWhole = !isPartialOperand;
+    isPartialOperand = false;
+
+    operandStarts.push_back(transpiler->getPosition());
     auto type = parseT();
-    return parseE1(type);
+    type = parseE1(type);
+
+    // whole expressions are folded with C's precedence; folding an operand
+    // alone could group it differently than C does
+    expressionConstant = "";
+    if (isWhole)
+        expressionConstant = transpiler->genFoldedExpression(
+            operandStarts.back(), [this](const std::string& name) {
+                return symboltable->getSymbolConstant(name);
+            });
+
+    operandStarts.pop_back();
+    return type;
+}
+
+/**
+ * E1 := Power E2 | E2
+ */
+std::string
+sailfishc::parseE1(const std::string& T0)
+{
+    if (currentToken->kind != TokenKind::EXPONENTIATION)
+        return parseE2(T0);
+
+    // the power is the left operand of whatever operator follows it
+    return parseE2(parsePower(T0));
 }
 
 /**
- * E1 := ** E0 | E2
+ * Power := ** T [MemberAccess | FunctionCall] [Power]
+ *
+ * ** binds tighter than any other operator and groups to the right, so its
+ * exponent is a single operand, itself possibly raised to a power
  *
  * Semantic Check
- *  - both are int
+ *  - both are int or both are flt
  */
 std::string
-sailfishc::parseE1(const std::string& T0)
+sailfishc::parsePower(const std::string& T0)
 {
-    return parseExpr(
-        T0,
-        [this](const std::string& T0) -> std::string {
-            return this->parseE2(T0);
-        },
-        [this](const std::string& T0, const std::string& T1) -> std::string {
-            this->checkType(T0, T1);
-            this->checkType("int", T0);
-            this->checkType("int", T1);
-            return T1;
-        },
-        std::make_tuple(TokenKind::EXPONENTIATION, "**"));
+    advanceAndCheckToken(TokenKind::EXPONENTIATION); // consume '**'
+    auto exponentStart = transpiler->getPosition();
+    operandStarts.push_back(exponentStart);
+
+    auto T1 = parseT();
+    while (currentToken->kind == TokenKind::DOT ||
+           currentToken->kind == TokenKind::TRIPLE_DOT)
+        T1 = parseMemberAccess(T1);
+    if (currentToken->kind == TokenKind::LPAREN)
+        T1 = parseE12(T1);
+    if (currentToken->kind == TokenKind::EXPONENTIATION)
+        T1 = parsePower(T1);
+
+    operandStarts.pop_back();
+
+    auto type =
+        symboltable->hasVariable(T0) ? symboltable->getSymbolType(T0) : T0;
+    std::string numType = type == "flt" ? "flt" : "int";
+
+    checkType(T0, T1);
+    checkType(numType, T0);
+    checkType(numType, T1);
+
+    transpiler->genPower(operandStarts.back(), exponentStart, numType == "flt");
+
+    return T1;
 }
 
 /**
@@ -1229,6 +2083,7 @@ sailfishc::parseE7(const std::string& T0)
             // check that the variable has been declared before used (and thus
             // initialized)
             this->checkExists(T0);
+            this->symboltable->setSymbolConstant(T0, "");
             // check that the two types are the same
             auto type = T0;
             if (!isPrimitive(T0))
@@ -1257,6 +2112,7 @@ sailfishc::parseE8(const std::string& T0)
     {
         advanceAndCheckToken(TokenKind::NEGATION); // consume '!'
         transpiler->genOperator("!");
+        isPartialOperand = true;
         auto type = parseE0();
 
         checkType("bool", type);
@@ -1268,7 +2124,11 @@ sailfishc::parseE8(const std::string& T0)
     {
         advanceAndCheckToken(TokenKind::UNARYADD); // consume '++'
         transpiler->genOperator("++");
+        isPartialOperand = true;
+        auto start = transpiler->getPosition();
         auto type = parseE0();
+        symboltable->setSymbolConstant(type, "");
+        countAssignment(start);
 
         checkType("num", type);
 
@@ -1279,7 +2139,11 @@ sailfishc::parseE8(const std::string& T0)
     {
         advanceAndCheckToken(TokenKind::UNARYMINUS); // consume '--'
         transpiler->genOperator("--");
+        isPartialOperand = true;
+        auto start = transpiler->getPosition();
         auto type = parseE0();
+        symboltable->setSymbolConstant(type, "");
+        countAssignment(start);
 
         checkType("num", type);
 
@@ -1308,6 +2172,7 @@ sailfishc::parseE9(const std::string& T0)
             this->checkType(T0, T1);
             this->checkType("num", T0);
             this->checkType("num", T1);
+            this->symboltable->setSymbolConstant(T0, "");
             return T1;
         },
         std::make_tuple(TokenKind::ADDTO, "+="),
@@ -1358,6 +2223,9 @@ sailfishc::parseE12(const std::string& T0)
 {
     if (currentToken->kind == TokenKind::LPAREN)
     {
+        // the function's name was just written
+        auto start = transpiler->getPosition() - (int)T0.size();
+
         transpiler->genLeftParen();
         checkExists(T0);
 
@@ -1366,6 +2234,17 @@ sailfishc::parseE12(const std::string& T0)
         auto output = checkFunctionCall(name, symboltable);
 
         transpiler->genRightParen();
+
+        if (!isUdt && name == currentFunction)
+            lastSelfCall = std::make_tuple(start, transpiler->getPosition());
+        else
+        {
+            transpiler->genInlineCall(name, start);
+            if (symboltable->isSymbolPure(name))
+                addPureCall(output, start);
+            else
+                ++sideEffects;
+        }
         return output;
     }
 
@@ -1461,6 +2340,7 @@ sailfishc::parseMethodAccess(const std::string& udtname,
     else
         transpiler->pushMethod(udtname, methodName);
 
+    auto start = transpiler->getPosition();
     transpiler->append(methodName);
 
     transpiler->genLeftParen();
@@ -1471,6 +2351,19 @@ sailfishc::parseMethodAccess(const std::string& udtname,
 
     transpiler->popMethod();
 
+    // any receiver of this udt type calls the same C function
+    if (isUdt && methodName == currentFunction &&
+        udtType == extractUDTName(filename))
+        lastSelfCall = std::make_tuple(start, transpiler->getPosition());
+    else
+    {
+        transpiler->genInlineCall(methodName, start);
+        if (st->isSymbolPure(methodName))
+            addPureCall(output, start);
+        else
+            ++sideEffects;
+    }
+
     return output;
 }
 
@@ -1515,6 +2408,7 @@ std::string
 sailfishc::parseNew()
 {
     advanceAndCheckToken(TokenKind::NEW); // consume new
+    ++sideEffects;
     switch (currentToken->kind)
     {
     case TokenKind::IDENTIFIER:
@@ -1859,6 +2753,7 @@ sailfishc::parseList()
 {
     auto v = currentToken->value;
     advanceAndCheckToken(TokenKind::LIST); // eat list
+    ++sideEffects;
     auto listVals = determineTypes(parseListValues(v));
 
     std::string type = transpiler->getDecType();
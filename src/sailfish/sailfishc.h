@@ -13,6 +13,9 @@
  * this was mostly written in binges between the hours of 10pm and 5am.
  */
 #pragma once
+#include "../common/BranchProfile.h"
+#include "../common/CompilerOptions.h"
+#include "../common/TimeReport.h"
 #include "../common/display.h"
 #include "../errorhandler/Error.h"
 #include "../errorhandler/ParserErrorHandler.h"
@@ -22,19 +25,38 @@
 #include "../semantics/SymbolTable.h"
 #include "../semantics/UDTTable.h"
 #include "../transpiler/transpiler.h"
+#include <algorithm>
 #include <cstdarg>
 #include <deque>
 #include <functional>
 #include <iomanip>
 #include <iostream>
+#include <limits>
+#include <map>
 #include <memory>
+#include <set>
 #include <tuple>
 #include <unordered_map>
 #include <variant>
 #include <vector>
 
+// a Tree branch as written to the buffer: where its header, block and first
+// statement begin and end, and what its guard does
+struct TreeBranch
+{
+    int index;         // its place in the source, from 1
+    std::string guard; // the guard's literal value, if constant
+    int start;
+    int blockStart;
+    int blockEnd;
+    bool isGuardPure; // the guard neither assigns nor has side effects
+    std::vector<std::tuple<std::string, std::string>> guardCalls;
+    int leadStart; // a leading declaration without side effects, or -1
+    int leadEnd;
+};
+
 using UdtFlagAndBufer =
-    std::tuple<std::shared_ptr<UDTTable>, bool, std::string>;
+    std::tuple<std::shared_ptr<UDTTable>, bool, std::string, InlineBodies>;
 
 class sailfishc
 {
@@ -50,6 +72,47 @@ class sailfishc
     std::string filename;
     bool isUdt;
     bool shouldDisplayErrors;
+    CompilerOptions options;
+
+    // tail call elimination: the function being parsed and its C parameters,
+    // the buffer span of the last call it made to itself, and the statements
+    // holding self calls in tail position
+    std::string currentFunction;
+    std::string currentFunctionOutput;
+    std::vector<std::tuple<std::string, std::string>> currentParameters;
+    std::tuple<int, int> lastSelfCall;
+    std::vector<std::tuple<int, int>> tailCalls;
+    std::vector<std::tuple<int, int>> returnTailCalls;
+
+    // where in the buffer each expression being parsed begins, for operators
+    // which have to rewrite their left operand
+    std::vector<int> operandStarts;
+
+    // constant folding: whether the next expression is the operand of an
+    // operator rather than a whole C expression, and the literal value of the
+    // last whole expression, if constant
+    bool isPartialOperand;
+    std::string expressionConstant;
+
+    // Trees with fewer cases stay as if chains, which are just as fast
+    const int SWITCH_MIN_CASES = 3;
+
+    // with a branch profile, guards true at least this often when tested are
+    // hinted as likely and those true at most this often as unlikely, the odds
+    // gcc assumes for __builtin_expect
+    const double LIKELY_BRANCH = 0.9;
+    const double UNLIKELY_BRANCH = 0.1;
+
+    // purity: counts of side effects (impure calls, writes through a UDT,
+    // allocations) and of assignments parsed so far, the C text and type of
+    // each pure call in the guard being parsed, the span of the last parsed
+    // block's leading declaration if it is free of both, and how many
+    // temporaries hold cached calls
+    int sideEffects;
+    int assignments;
+    std::vector<std::tuple<std::string, std::string>> guardCalls;
+    std::tuple<int, int> leadingDeclaration;
+    int cachedCalls;
 
     // helper for simplifying redundancy of recursive loops
     template <typename F>
@@ -92,6 +155,15 @@ class sailfishc
                const G& g)
     {
         advanceAndCheckToken(tk); // consume token
+
+        // only the right of an assignment is a whole C expression
+        isPartialOperand =
+            tk != TokenKind::ASSIGNMENT && tk != TokenKind::ADDTO &&
+            tk != TokenKind::SUBFROM && tk != TokenKind::DIVFROM &&
+            tk != TokenKind::MULTTO;
+        if (!isPartialOperand)
+            countAssignment(operandStarts.back());
+
         transpiler->genOperator(symbol);
         auto type = parseE0();
 
@@ -119,6 +191,15 @@ class sailfishc
     }
 
     // semantic checker methods
+    void rewriteBuffer(int, int, const std::string&);
+    bool lowerTreeToSwitch(const std::vector<TreeBranch>&);
+    void applyBranchProfile(std::vector<TreeBranch>&, int, int);
+    bool reorderTreeBranches(std::vector<TreeBranch>&, std::vector<long>&);
+    void hintTreeBranches(std::vector<TreeBranch>&, const std::vector<long>&,
+                          long);
+    void cachePureCalls(const std::vector<TreeBranch>&);
+    void addPureCall(const std::string&, int);
+    void countAssignment(int);
     void checkType(const std::string&, const std::string&);
     void checkUnique(const std::string&);
     void checkExists(const std::string&);
@@ -141,18 +222,20 @@ class sailfishc
     void parseMethods(std::shared_ptr<SymbolTable>);
     void parseScript();
     void parseFunctionDefinition();
-    void parseFunctionInfo(const std::string&);
+    void parseFunctionInfo(const std::string&, int);
     std::string parseFunctionInOut(const std::string& name);
     void parseStart();
     std::string parseBlock();
     std::tuple<std::string, std::string> parseStatement();
     void parseTree();
-    void parseBranch();
-    void parseGrouping();
+    TreeBranch parseBranch(int, int, int);
+    std::string parseGrouping();
     std::string parseReturn();
+    void parseDelete();
     std::string parseDeclaration();
     std::string parseE0();
     std::string parseE1(const std::string&);
+    std::string parsePower(const std::string&);
     std::string parseE2(const std::string&);
     std::string parseE3(const std::string&);
     std::string parseE4(const std::string&);
@@ -188,7 +271,8 @@ class sailfishc
 
   public:
     void parse();
-    sailfishc(const std::string& file, bool shouldDisplayErrors);
+    sailfishc(const std::string& file, bool shouldDisplayErrors,
+              const CompilerOptions& options = CompilerOptions());
 
     std::shared_ptr<SymbolTable>
     getSymbolTable()
@@ -13,6 +13,8 @@ class SymbolMetaData
   private:
     std::string type;
     int scopeLevel;
+    std::string constant; // the literal a variable is known to hold, if any
+    bool pure = false;    // a function which has no side effects
 
   public:
     // constructor
@@ -34,4 +36,25 @@ class SymbolMetaData
     {
         return scopeLevel;
     }
+    std::string
+    getConstant()
+    {
+        return constant;
+    }
+    bool
+    isPure()
+    {
+        return pure;
+    }
+    // set methods
+    void
+    setConstant(const std::string& c)
+    {
+        constant = c;
+    }
+    void
+    setPure(bool p)
+    {
+        pure = p;
+    }
 };
\ No newline at end of file
@@ -8,6 +8,7 @@
 std::vector<std::string>
 addToLocalCache(std::string varName, std::vector<std::string> localCache)
 {
+    compileStats().localCacheCopies += localCache.size();
     localCache.push_back(varName);
     return localCache;
 }
@@ -63,6 +64,7 @@ SymbolTable::enterScope()
     // hard code add a scope seperator
     localCache.push_back("|");
     ++scopeLevel;
+    ++compileStats().scopesEntered;
 }
 
 bool
@@ -93,9 +95,51 @@ SymbolTable::getSymbolScope(const std::string varName)
     return -1;
 }
 
+std::string
+SymbolTable::getSymbolConstant(const std::string varName)
+{
+    if (hasVariable(varName))
+    {
+        return globalScopeTable.find(varName)->second.top()->getConstant();
+    }
+
+    return "";
+}
+
+void
+SymbolTable::setSymbolConstant(const std::string varName,
+                               const std::string constant)
+{
+    if (hasVariable(varName))
+    {
+        globalScopeTable.find(varName)->second.top()->setConstant(constant);
+    }
+}
+
+bool
+SymbolTable::isSymbolPure(const std::string varName)
+{
+    if (hasVariable(varName))
+    {
+        return globalScopeTable.find(varName)->second.top()->isPure();
+    }
+
+    return false;
+}
+
+void
+SymbolTable::setSymbolPure(const std::string varName, bool pure)
+{
+    if (hasVariable(varName))
+    {
+        globalScopeTable.find(varName)->second.top()->setPure(pure);
+    }
+}
+
 bool
 SymbolTable::addSymbol(const std::string varName, const std::string type)
 {
+    ++compileStats().symbolsInserted;
     if (hasVariable(varName))
     {
         // ensure not adding a variable if already exists in this scope
@@ -131,6 +175,7 @@ SymbolTable::removeSymbol(const std::string& varName)
 void
 SymbolTable::addStdlib(const std::string varName, const std::string type)
 {
+    ++compileStats().symbolsInserted;
     std::stack<SymbolMetaData*> ss;
     SymbolMetaData* smd = new SymbolMetaData(type, scopeLevel);
     ss.push(smd);
@@ -152,11 +197,31 @@ SymbolTable::addBuiltins()
     addSymbol("appendListBool", "F(_[bool]_[bool]_int_int)[bool]");
     addSymbol("appendListFlt", "F(_[flt]_[flt]_int_int)[flt]");
 
+    addSymbol("pushListInt", "F(_[int]_int_int)[int]");
+    addSymbol("pushListStr", "F(_[str]_int_str)[str]");
+    addSymbol("pushListBool", "F(_[bool]_int_bool)[bool]");
+    addSymbol("pushListFlt", "F(_[flt]_int_flt)[flt]");
+
+    addSymbol("extendListInt", "F(_[int]_[int]_int_int)[int]");
+    addSymbol("extendListStr", "F(_[str]_[str]_int_int)[str]");
+    addSymbol("extendListBool", "F(_[bool]_[bool]_int_int)[bool]");
+    addSymbol("extendListFlt", "F(_[flt]_[flt]_int_int)[flt]");
+
     addSymbol("deleteAtIndexInt", "F(_[int]_int_int)[int]");
     addSymbol("deleteAtIndexStr", "F(_[str]_int_int)[str]");
     addSymbol("deleteAtIndexBool", "F(_[bool]_int_int)[bool]");
     addSymbol("deleteAtIndexFlt", "F(_[flt]_int_int)[flt]");
 
+    addSymbol("removeAtIndexInt", "F(_[int]_int_int)[int]");
+    addSymbol("removeAtIndexStr", "F(_[str]_int_int)[str]");
+    addSymbol("removeAtIndexBool", "F(_[bool]_int_int)[bool]");
+    addSymbol("removeAtIndexFlt", "F(_[flt]_int_int)[flt]");
+
+    addSymbol("removeRangeInt", "F(_[int]_int_int_int)[int]");
+    addSymbol("removeRangeStr", "F(_[str]_int_int_int)[str]");
+    addSymbol("removeRangeBool", "F(_[bool]_int_int_int)[bool]");
+    addSymbol("removeRangeFlt", "F(_[flt]_int_int_int)[flt]");
+
     addSymbol("getAtIndexInt", "F(_[int]_int)int");
     addSymbol("getAtIndexStr", "F(_[str]_int)str");
     addSymbol("getAtIndexBool", "F(_[bool]_int)bool");
@@ -167,8 +232,46 @@ SymbolTable::addBuiltins()
     addSymbol("setAtIndexBool", "F(_[bool]_int_bool)[bool]");
     addSymbol("setAtIndexFlt", "F(_[flt]_int_flt)[flt]");
 
+    // [any] accepts a list of any element type
+    addSymbol("len", "F(_[any])int");
+
+    addSymbol("sumListInt", "F(_[int])int");
+    addSymbol("sumListFlt", "F(_[flt])flt");
+    addSymbol("minListInt", "F(_[int])int");
+    addSymbol("minListFlt", "F(_[flt])flt");
+    addSymbol("maxListInt", "F(_[int])int");
+    addSymbol("maxListFlt", "F(_[flt])flt");
+    addSymbol("dotListInt", "F(_[int]_[int])int");
+    addSymbol("dotListFlt", "F(_[flt]_[flt])flt");
+    addSymbol("scaleListInt", "F(_[int]_int)[int]");
+    addSymbol("scaleListFlt", "F(_[flt]_flt)[flt]");
+    addSymbol("addListInt", "F(_[int]_[int])[int]");
+    addSymbol("addListFlt", "F(_[flt]_[flt])[flt]");
+    addSymbol("fillListInt", "F(_[int]_int)[int]");
+    addSymbol("fillListFlt", "F(_[flt]_flt)[flt]");
+
+    addSymbol("sortListInt", "F(_[int])[int]");
+    addSymbol("sortListFlt", "F(_[flt])[flt]");
+    addSymbol("sortListStr", "F(_[str])[str]");
+
+    addSymbol("arenaMark", "F(_void)int");
+    addSymbol("arenaRelease", "F(_int)void");
+    addSymbol("resetArena", "F(_void)void");
+
     addSymbol("printInt", "F(_int)void");
     addSymbol("printStr", "F(_str)void");
     addSymbol("printBool", "F(_bool)void");
     addSymbol("printFlt", "F(_flt)void");
+
+    addSymbol("printListInt", "F(_[int])void");
+    addSymbol("printListStr", "F(_[str])void");
+    addSymbol("printListBool", "F(_[bool])void");
+    addSymbol("printListFlt", "F(_[flt])void");
+
+    // builtins which only read their inputs
+    for (auto const& name :
+         {"getAtIndexInt", "getAtIndexStr", "getAtIndexBool", "getAtIndexFlt",
+          "len", "sumListInt", "sumListFlt", "minListInt", "minListFlt",
+          "maxListInt", "maxListFlt", "dotListInt", "dotListFlt"})
+        setSymbolPure(name, true);
 }
@@ -5,6 +5,7 @@
  * SymbolTable maps variable names to types.
  */
 #pragma once
+#include "../common/CompileStats.h"
 #include "SymbolMetaData.h"
 #include <iomanip>
 #include <iostream>
@@ -50,6 +51,20 @@ class SymbolTable
     // retreive a symbol's scope level from the symbol table
     int getSymbolScope(const std::string);
 
+    // retreive the literal a symbol is known to hold, or "" if it may hold
+    // anything
+    std::string getSymbolConstant(const std::string);
+
+    // record the literal a symbol holds, "" once it may hold anything
+    void setSymbolConstant(const std::string, const std::string);
+
+    // whether a function symbol is known to have no side effects, so that
+    // calling it twice with the same arguments gives the same result
+    bool isSymbolPure(const std::string);
+
+    // record whether a function symbol has no side effects
+    void setSymbolPure(const std::string, bool);
+
     // either push to the variables scope if exists or add variable
     bool addSymbol(const std::string, const std::string);
 
@@ -62,6 +62,7 @@ class UDTTable
 
         UDTMetaData* udtmd = new UDTMetaData(attributes, methods);
         udtTable.insert({name, udtmd});
+        ++compileStats().udtsRegistered;
         return true;
     }
 };
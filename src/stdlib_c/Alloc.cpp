@@ -0,0 +1,18 @@
+/*
+ * Robert Durst 2019
+ * Sailfish Programming Language
+ */
+#include "Alloc.h"
+std::string
+getAllocStdLibC()
+{
+    return ARENA + REPORT_ALLOCS + START_ALLOCS + SET_ARENA_ALLOCATION +
+           ARENA_ALLOC + SF_ALLOC + SF_REALLOC + SF_FREE + POOL + REFILL_POOL +
+           ARENA_MARK + ARENA_RELEASE + RESET_ARENA;
+}
+
+std::string
+getAllocStdLibCDeclarations()
+{
+    return ALLOC_DECLARATIONS;
+}
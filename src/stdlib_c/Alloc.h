@@ -0,0 +1,215 @@
+/*
+ * Robert Durst 2019
+ * Sailfish Programming Language
+ */
+#pragma once
+#include <string>
+
+// Allocation for UDT instances and lists: plain malloc by default, or a bump
+// pointer arena when the program is compiled with --arena.
+const static std::string ALLOC_DECLARATIONS =
+    "\nvoid setArenaAllocation(int on);"
+    "\nvoid* sfAlloc(size_t size);"
+    "\nvoid* sfRealloc(void* memory, size_t oldSize, size_t size);"
+    "\nvoid sfFree(void* memory);"
+    "\nvoid* refillPool(void** pool, size_t size);"
+    "\nint arenaMark(void);"
+    "\nvoid arenaRelease(int mark);"
+    "\nvoid resetArena(void);\n";
+
+const static std::string ARENA =
+    "\n/* UDT instances and lists are allocated through sfAlloc. By default it is"
+    "\n   malloc. With arena allocation on, memory is bumped out of large chunks"
+    "\n   instead and only given back all at once, by resetArena or by releasing"
+    "\n   back to a mark taken with arenaMark. Setting SAILFISH_ALLOC_STATS prints"
+    "\n   allocation counts at exit. */"
+    "\n#define ARENA_CHUNK_SIZE (1 << 20)"
+    "\n"
+    "\ntypedef struct ArenaChunk"
+    "\n{"
+    "\n    struct ArenaChunk* previous;"
+    "\n    size_t start;"
+    "\n    size_t size;"
+    "\n    size_t used;"
+    "\n} __attribute__((aligned(16))) ArenaChunk;"
+    "\n"
+    "\nstatic int arenaAllocation = 0;"
+    "\nstatic ArenaChunk* arenaChunk = NULL;"
+    "\nstatic size_t allocCount = 0;"
+    "\nstatic size_t allocBytes = 0;"
+    "\nstatic size_t freeCount = 0;"
+    "\nstatic size_t chunkCount = 0;"
+    "\nstatic int allocStarted = 0;\n";
+
+const static std::string REPORT_ALLOCS =
+    "\nstatic void"
+    "\nreportAllocs(void)"
+    "\n{"
+    "\n    fprintf(stderr, \"[alloc] mode: %s\\n\","
+    "\n            arenaAllocation ? \"arena\" : \"malloc\");"
+    "\n    fprintf(stderr, \"[alloc] allocations: %zu\\n\", allocCount);"
+    "\n    fprintf(stderr, \"[alloc] bytes: %zu\\n\", allocBytes);"
+    "\n    fprintf(stderr, \"[alloc] frees: %zu\\n\", freeCount);"
+    "\n    fprintf(stderr, \"[alloc] arena chunks: %zu\\n\", chunkCount);"
+    "\n}\n";
+
+const static std::string START_ALLOCS =
+    "\nstatic void"
+    "\nstartAllocs(void)"
+    "\n{"
+    "\n    allocStarted = 1;"
+    "\n    if (getenv(\"SAILFISH_ALLOC_STATS\") != NULL)"
+    "\n        atexit(reportAllocs);"
+    "\n}\n";
+
+const static std::string SET_ARENA_ALLOCATION =
+    "\nvoid"
+    "\nsetArenaAllocation(int on)"
+    "\n{"
+    "\n    arenaAllocation = on;"
+    "\n}\n";
+
+const static std::string ARENA_ALLOC =
+    "\nstatic void*"
+    "\narenaAlloc(size_t size)"
+    "\n{"
+    "\n    ArenaChunk* chunk = arenaChunk;"
+    "\n    void* memory;"
+    "\n"
+    "\n    size = (size + 15) & ~(size_t)15;"
+    "\n    if (chunk == NULL || chunk->size - chunk->used < size)"
+    "\n    {"
+    "\n        size_t chunkSize = size > ARENA_CHUNK_SIZE ? size : ARENA_CHUNK_SIZE;"
+    "\n        chunk = malloc(sizeof(ArenaChunk) + chunkSize);"
+    "\n        chunk->previous = arenaChunk;"
+    "\n        chunk->start = arenaChunk == NULL"
+    "\n                           ? 0"
+    "\n                           : arenaChunk->start + arenaChunk->used;"
+    "\n        chunk->size = chunkSize;"
+    "\n        chunk->used = 0;"
+    "\n        arenaChunk = chunk;"
+    "\n        chunkCount++;"
+    "\n    }"
+    "\n"
+    "\n    memory = (char*)(chunk + 1) + chunk->used;"
+    "\n    chunk->used += size;"
+    "\n    return memory;"
+    "\n}\n";
+
+const static std::string SF_ALLOC =
+    "\nvoid*"
+    "\nsfAlloc(size_t size)"
+    "\n{"
+    "\n    if (!allocStarted)"
+    "\n        startAllocs();"
+    "\n    allocCount++;"
+    "\n    allocBytes += size;"
+    "\n    return arenaAllocation ? arenaAlloc(size) : malloc(size);"
+    "\n}\n";
+
+const static std::string SF_REALLOC =
+    "\nvoid*"
+    "\nsfRealloc(void* memory, size_t oldSize, size_t size)"
+    "\n{"
+    "\n    void* moved;"
+    "\n    if (!arenaAllocation)"
+    "\n    {"
+    "\n        if (!allocStarted)"
+    "\n            startAllocs();"
+    "\n        allocCount++;"
+    "\n        allocBytes += size;"
+    "\n        return realloc(memory, size);"
+    "\n    }"
+    "\n"
+    "\n    moved = sfAlloc(size);"
+    "\n    if (memory != NULL)"
+    "\n        memcpy(moved, memory, oldSize < size ? oldSize : size);"
+    "\n    return moved;"
+    "\n}\n";
+
+const static std::string SF_FREE =
+    "\nvoid"
+    "\nsfFree(void* memory)"
+    "\n{"
+    "\n    if (memory == NULL || arenaAllocation)"
+    "\n        return;"
+    "\n    freeCount++;"
+    "\n    free(memory);"
+    "\n}\n";
+
+const static std::string POOL =
+    "\n/* Every UDT gets a free list of released instances, threaded through their"
+    "\n   first bytes. An empty pool is refilled with a slab of POOL_SLAB instances"
+    "\n   so they sit next to each other in memory. Pools are registered here so"
+    "\n   that releasing the arena can drop instances that lived in it. */"
+    "\n#define POOL_SLAB 64"
+    "\n"
+    "\nstatic void*** pools = NULL;"
+    "\nstatic int poolCount = 0;\n";
+
+const static std::string REFILL_POOL =
+    "\nvoid*"
+    "\nrefillPool(void** pool, size_t size)"
+    "\n{"
+    "\n    char* slab;"
+    "\n    int i;"
+    "\n"
+    "\n    for (i = 0; i < poolCount && pools[i] != pool; i++)"
+    "\n        ;"
+    "\n    if (i == poolCount)"
+    "\n    {"
+    "\n        pools = realloc(pools, (poolCount + 1) * sizeof(void**));"
+    "\n        pools[poolCount++] = pool;"
+    "\n    }"
+    "\n"
+    "\n    if (size < sizeof(void*))"
+    "\n        size = sizeof(void*);"
+    "\n    size = (size + sizeof(void*) - 1) & ~(sizeof(void*) - 1);"
+    "\n    slab = sfAlloc(POOL_SLAB * size);"
+    "\n    for (i = POOL_SLAB - 1; i >= 0; i--)"
+    "\n    {"
+    "\n        *(void**)(slab + i * size) = *pool;"
+    "\n        *pool = slab + i * size;"
+    "\n    }"
+    "\n    return *pool;"
+    "\n}\n";
+
+const static std::string ARENA_MARK =
+    "\n/* arena position to release back to; a plain count of bytes handed out */"
+    "\nint"
+    "\narenaMark(void)"
+    "\n{"
+    "\n    if (arenaChunk == NULL)"
+    "\n        return 0;"
+    "\n    return (int)(arenaChunk->start + arenaChunk->used);"
+    "\n}\n";
+
+const static std::string ARENA_RELEASE =
+    "\nvoid"
+    "\narenaRelease(int mark)"
+    "\n{"
+    "\n    int i;"
+    "\n    if (arenaAllocation)"
+    "\n        for (i = 0; i < poolCount; i++)"
+    "\n            *pools[i] = NULL;"
+    "\n"
+    "\n    while (arenaChunk != NULL && arenaChunk->start > (size_t)mark)"
+    "\n    {"
+    "\n        ArenaChunk* previous = arenaChunk->previous;"
+    "\n        free(arenaChunk);"
+    "\n        arenaChunk = previous;"
+    "\n    }"
+    "\n    if (arenaChunk != NULL &&"
+    "\n        arenaChunk->start + arenaChunk->used > (size_t)mark)"
+    "\n        arenaChunk->used = mark - arenaChunk->start;"
+    "\n}\n";
+
+const static std::string RESET_ARENA =
+    "\nvoid"
+    "\nresetArena(void)"
+    "\n{"
+    "\n    arenaRelease(0);"
+    "\n}\n";
+
+std::string getAllocStdLibC();
+std::string getAllocStdLibCDeclarations();
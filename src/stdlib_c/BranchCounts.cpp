@@ -0,0 +1,17 @@
+/*
+ * Robert Durst 2019
+ * Sailfish Programming Language
+ */
+#include "BranchCounts.h"
+std::string
+getBranchCountsStdLibC()
+{
+    return BRANCH_COUNTS_STATE + WRITE_BRANCH_PROFILE + START_BRANCH_PROFILE +
+           COUNT_BRANCH;
+}
+
+std::string
+getBranchCountsStdLibCDeclarations()
+{
+    return BRANCH_COUNTS_DECLARATIONS;
+}
@@ -0,0 +1,70 @@
+/*
+ * Robert Durst 2019
+ * Sailfish Programming Language
+ */
+#pragma once
+#include <string>
+
+// Tree branch counts for programs compiled with --profile-generate, which
+// gives every Tree and branch a BranchSite.
+const static std::string BRANCH_COUNTS_DECLARATIONS =
+    "\ntypedef struct BranchSite"
+    "\n{"
+    "\n    const char* file;"
+    "\n    int line;"
+    "\n    int column;"
+    "\n    int branch;"
+    "\n    long count;"
+    "\n    struct BranchSite* next;"
+    "\n} BranchSite;"
+    "\nvoid startBranchProfile(const char* path);"
+    "\nvoid countBranch(BranchSite* site);\n";
+
+const static std::string BRANCH_COUNTS_STATE =
+    "\n/* Programs compiled with --profile-generate count how often every Tree is"
+    "\n   reached and each of its branches taken, in a BranchSite of their own, and"
+    "\n   at exit add the counts of the sites which were reached to the profile, one"
+    "\n   \"file\\tline\\tcolumn\\tbranch\\tcount\" line each, for --profile-use. */"
+    "\nstatic BranchSite* branchSites = NULL;"
+    "\nstatic const char* branchProfilePath = NULL;\n";
+
+const static std::string WRITE_BRANCH_PROFILE =
+    "\nstatic void"
+    "\nwriteBranchProfile()"
+    "\n{"
+    "\n    FILE* out = fopen(branchProfilePath, \"a\");"
+    "\n    BranchSite* site;"
+    "\n"
+    "\n    if (out == NULL)"
+    "\n    {"
+    "\n        fprintf(stderr, \"[profile] unable to write %s\\n\", branchProfilePath);"
+    "\n        return;"
+    "\n    }"
+    "\n"
+    "\n    for (site = branchSites; site != NULL; site = site->next)"
+    "\n        fprintf(out, \"%s\\t%d\\t%d\\t%d\\t%ld\\n\", site->file, site->line,"
+    "\n                site->column, site->branch, site->count);"
+    "\n    fclose(out);"
+    "\n}\n";
+
+const static std::string START_BRANCH_PROFILE =
+    "\nvoid"
+    "\nstartBranchProfile(const char* path)"
+    "\n{"
+    "\n    branchProfilePath = path;"
+    "\n    atexit(writeBranchProfile);"
+    "\n}\n";
+
+const static std::string COUNT_BRANCH =
+    "\nvoid"
+    "\ncountBranch(BranchSite* site)"
+    "\n{"
+    "\n    if (site->count++ == 0)"
+    "\n    {"
+    "\n        site->next = branchSites;"
+    "\n        branchSites = site;"
+    "\n    }"
+    "\n}\n";
+
+std::string getBranchCountsStdLibC();
+std::string getBranchCountsStdLibCDeclarations();
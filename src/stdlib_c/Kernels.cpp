@@ -0,0 +1,51 @@
+/*
+ * Robert Durst 2019
+ * Sailfish Programming Language
+ */
+#include "Kernels.h"
+#include <utility>
+#include <vector>
+
+namespace
+{
+// each kernel's name and C
+const std::vector<std::pair<std::string, std::string>>&
+kernels()
+{
+    static const std::vector<std::pair<std::string, std::string>> all = {
+        {"sumListInt", SUM_LIST_INT},     {"sumListFlt", SUM_LIST_FLT},
+        {"minListInt", MIN_LIST_INT},     {"minListFlt", MIN_LIST_FLT},
+        {"maxListInt", MAX_LIST_INT},     {"maxListFlt", MAX_LIST_FLT},
+        {"dotListInt", DOT_LIST_INT},     {"dotListFlt", DOT_LIST_FLT},
+        {"scaleListInt", SCALE_LIST_INT}, {"scaleListFlt", SCALE_LIST_FLT},
+        {"addListInt", ADD_LIST_INT},     {"addListFlt", ADD_LIST_FLT},
+        {"fillListInt", FILL_LIST_INT},   {"fillListFlt", FILL_LIST_FLT},
+    };
+    return all;
+}
+} // namespace
+
+std::string
+getKernelsStdLibC()
+{
+    std::string c = KERNELS_HEADER;
+    for (auto const& kernel : kernels())
+        c += kernel.second;
+    return c;
+}
+
+std::string
+getKernelsStdLibC(const std::string& program)
+{
+    std::string c;
+    for (auto const& kernel : kernels())
+        if (program.find(kernel.first + "(") != std::string::npos)
+            c += kernel.second;
+    return c == "" ? c : KERNELS_HEADER + c;
+}
+
+std::string
+getKernelsStdLibCDeclarations()
+{
+    return KERNELS_DECLARATIONS;
+}
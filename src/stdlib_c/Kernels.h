@@ -0,0 +1,859 @@
+/*
+ * Robert Durst 2019
+ * Sailfish Programming Language
+ */
+#pragma once
+#include <string>
+
+// Numeric kernels over [int] and [flt] lists. Each kernel has an avx2, an
+// sse4.1 and a scalar version; simdLevel picks one the first time a kernel
+// runs, based on what the cpu supports. With gcc the loops of the kernels are
+// compiled with -O2 even when out.c is not, since they are only worth having
+// when optimized. out.c only carries the kernels its program calls.
+const static std::string KERNELS_DECLARATIONS =
+    "\nint sumListInt(int* a);"
+    "\nint minListInt(int* a);"
+    "\nint maxListInt(int* a);"
+    "\nint dotListInt(int* a, int* b);"
+    "\nint* scaleListInt(int* a, int k);"
+    "\nint* addListInt(int* a, int* b);"
+    "\nint* fillListInt(int* a, int value);"
+    "\nfloat sumListFlt(float* a);"
+    "\nfloat minListFlt(float* a);"
+    "\nfloat maxListFlt(float* a);"
+    "\nfloat dotListFlt(float* a, float* b);"
+    "\nfloat* scaleListFlt(float* a, float k);"
+    "\nfloat* addListFlt(float* a, float* b);"
+    "\nfloat* fillListFlt(float* a, float value);\n";
+
+const static std::string KERNELS_HEADER =
+    "\n#if defined(__x86_64__) || defined(__i386__)"
+    "\n#include <immintrin.h>"
+    "\n#define SAILFISH_X86"
+    "\n#endif"
+    "\n"
+    "\n#if defined(__GNUC__) && !defined(__clang__)"
+    "\n#define SAILFISH_KERNEL __attribute__((optimize(\"O2\")))"
+    "\n#else"
+    "\n#define SAILFISH_KERNEL"
+    "\n#endif"
+    "\n"
+    "\n/* 2 for avx2, 1 for sse4.1 and 0 for scalar code. Setting SAILFISH_SIMD"
+    "\n   lowers the level, to compare implementations. */"
+    "\nstatic int"
+    "\nsimdLevel(void)"
+    "\n{"
+    "\n    static int level = -1;"
+    "\n    char* forced;"
+    "\n"
+    "\n    if (level >= 0)"
+    "\n        return level;"
+    "\n"
+    "\n    level = 0;"
+    "\n#ifdef SAILFISH_X86"
+    "\n    __builtin_cpu_init();"
+    "\n    if (__builtin_cpu_supports(\"avx2\"))"
+    "\n        level = 2;"
+    "\n    else if (__builtin_cpu_supports(\"sse4.1\"))"
+    "\n        level = 1;"
+    "\n#endif"
+    "\n    forced = getenv(\"SAILFISH_SIMD\");"
+    "\n    if (forced != NULL && atoi(forced) < level)"
+    "\n        level = atoi(forced);"
+    "\n    return level;"
+    "\n}\n";
+
+const static std::string SUM_LIST_INT =
+    "\nSAILFISH_KERNEL static int"
+    "\nsumIntScalar(int* a, int from, int n)"
+    "\n{"
+    "\n    unsigned int total = 0;"
+    "\n    int i;"
+    "\n    for (i = from; i < n; i++)"
+    "\n        total += (unsigned int)a[i];"
+    "\n    return (int)total;"
+    "\n}"
+    "\n"
+    "\n#ifdef SAILFISH_X86"
+    "\n__attribute__((target(\"sse4.1\"))) SAILFISH_KERNEL static int"
+    "\nsumIntSse(int* a, int n)"
+    "\n{"
+    "\n    __m128i total = _mm_setzero_si128();"
+    "\n    int lanes[4];"
+    "\n    unsigned int result;"
+    "\n    int i;"
+    "\n    for (i = 0; i + 4 <= n; i += 4)"
+    "\n        total = _mm_add_epi32(total, _mm_loadu_si128((__m128i*)(a + i)));"
+    "\n    _mm_storeu_si128((__m128i*)lanes, total);"
+    "\n    result = sumIntScalar(a, i, n);"
+    "\n    for (i = 0; i < 4; i++)"
+    "\n        result += (unsigned int)lanes[i];"
+    "\n    return (int)result;"
+    "\n}"
+    "\n"
+    "\n__attribute__((target(\"avx2\"))) SAILFISH_KERNEL static int"
+    "\nsumIntAvx(int* a, int n)"
+    "\n{"
+    "\n    __m256i total = _mm256_setzero_si256();"
+    "\n    int lanes[8];"
+    "\n    unsigned int result;"
+    "\n    int i;"
+    "\n    for (i = 0; i + 8 <= n; i += 8)"
+    "\n        total = _mm256_add_epi32(total, _mm256_loadu_si256((__m256i*)(a + i)));"
+    "\n    _mm256_storeu_si256((__m256i*)lanes, total);"
+    "\n    result = sumIntScalar(a, i, n);"
+    "\n    for (i = 0; i < 8; i++)"
+    "\n        result += (unsigned int)lanes[i];"
+    "\n    return (int)result;"
+    "\n}"
+    "\n#endif"
+    "\n"
+    "\nint"
+    "\nsumListInt(int* a)"
+    "\n{"
+    "\n    int n = len(a);"
+    "\n#ifdef SAILFISH_X86"
+    "\n    if (simdLevel() == 2)"
+    "\n        return sumIntAvx(a, n);"
+    "\n    if (simdLevel() == 1)"
+    "\n        return sumIntSse(a, n);"
+    "\n#endif"
+    "\n    return sumIntScalar(a, 0, n);"
+    "\n}\n";
+
+const static std::string SUM_LIST_FLT =
+    "\nSAILFISH_KERNEL static float"
+    "\nsumFltScalar(float* a, int from, int n)"
+    "\n{"
+    "\n    float total = 0;"
+    "\n    int i;"
+    "\n    for (i = from; i < n; i++)"
+    "\n        total += a[i];"
+    "\n    return total;"
+    "\n}"
+    "\n"
+    "\n#ifdef SAILFISH_X86"
+    "\n__attribute__((target(\"sse4.1\"))) SAILFISH_KERNEL static float"
+    "\nsumFltSse(float* a, int n)"
+    "\n{"
+    "\n    __m128 total = _mm_setzero_ps();"
+    "\n    float lanes[4];"
+    "\n    float result;"
+    "\n    int i;"
+    "\n    for (i = 0; i + 4 <= n; i += 4)"
+    "\n        total = _mm_add_ps(total, _mm_loadu_ps(a + i));"
+    "\n    _mm_storeu_ps(lanes, total);"
+    "\n    result = sumFltScalar(a, i, n);"
+    "\n    for (i = 0; i < 4; i++)"
+    "\n        result += lanes[i];"
+    "\n    return result;"
+    "\n}"
+    "\n"
+    "\n__attribute__((target(\"avx2\"))) SAILFISH_KERNEL static float"
+    "\nsumFltAvx(float* a, int n)"
+    "\n{"
+    "\n    __m256 total = _mm256_setzero_ps();"
+    "\n    float lanes[8];"
+    "\n    float result;"
+    "\n    int i;"
+    "\n    for (i = 0; i + 8 <= n; i += 8)"
+    "\n        total = _mm256_add_ps(total, _mm256_loadu_ps(a + i));"
+    "\n    _mm256_storeu_ps(lanes, total);"
+    "\n    result = sumFltScalar(a, i, n);"
+    "\n    for (i = 0; i < 8; i++)"
+    "\n        result += lanes[i];"
+    "\n    return result;"
+    "\n}"
+    "\n#endif"
+    "\n"
+    "\nfloat"
+    "\nsumListFlt(float* a)"
+    "\n{"
+    "\n    int n = len(a);"
+    "\n#ifdef SAILFISH_X86"
+    "\n    if (simdLevel() == 2)"
+    "\n        return sumFltAvx(a, n);"
+    "\n    if (simdLevel() == 1)"
+    "\n        return sumFltSse(a, n);"
+    "\n#endif"
+    "\n    return sumFltScalar(a, 0, n);"
+    "\n}\n";
+
+const static std::string MIN_LIST_INT =
+    "\nSAILFISH_KERNEL static int"
+    "\nminIntScalar(int* a, int from, int n, int best)"
+    "\n{"
+    "\n    int i;"
+    "\n    for (i = from; i < n; i++)"
+    "\n        if (a[i] < best)"
+    "\n            best = a[i];"
+    "\n    return best;"
+    "\n}"
+    "\n"
+    "\n#ifdef SAILFISH_X86"
+    "\n__attribute__((target(\"sse4.1\"))) SAILFISH_KERNEL static int"
+    "\nminIntSse(int* a, int n)"
+    "\n{"
+    "\n    __m128i best;"
+    "\n    int lanes[4];"
+    "\n    int i;"
+    "\n    if (n < 4)"
+    "\n        return minIntScalar(a, 0, n, a[0]);"
+    "\n"
+    "\n    best = _mm_loadu_si128((__m128i*)(a));"
+    "\n    for (i = 4; i + 4 <= n; i += 4)"
+    "\n        best = _mm_min_epi32(best, _mm_loadu_si128((__m128i*)(a + i)));"
+    "\n    _mm_storeu_si128((__m128i*)lanes, best);"
+    "\n    return minIntScalar(lanes, 1, 4, minIntScalar(a, i, n, lanes[0]));"
+    "\n}"
+    "\n"
+    "\n__attribute__((target(\"avx2\"))) SAILFISH_KERNEL static int"
+    "\nminIntAvx(int* a, int n)"
+    "\n{"
+    "\n    __m256i best;"
+    "\n    int lanes[8];"
+    "\n    int i;"
+    "\n    if (n < 8)"
+    "\n        return minIntScalar(a, 0, n, a[0]);"
+    "\n"
+    "\n    best = _mm256_loadu_si256((__m256i*)(a));"
+    "\n    for (i = 8; i + 8 <= n; i += 8)"
+    "\n        best = _mm256_min_epi32(best, _mm256_loadu_si256((__m256i*)(a + i)));"
+    "\n    _mm256_storeu_si256((__m256i*)lanes, best);"
+    "\n    return minIntScalar(lanes, 1, 8, minIntScalar(a, i, n, lanes[0]));"
+    "\n}"
+    "\n#endif"
+    "\n"
+    "\nint"
+    "\nminListInt(int* a)"
+    "\n{"
+    "\n    int n = len(a);"
+    "\n    if (n == 0)"
+    "\n        return 0;"
+    "\n#ifdef SAILFISH_X86"
+    "\n    if (simdLevel() == 2)"
+    "\n        return minIntAvx(a, n);"
+    "\n    if (simdLevel() == 1)"
+    "\n        return minIntSse(a, n);"
+    "\n#endif"
+    "\n    return minIntScalar(a, 1, n, a[0]);"
+    "\n}\n";
+
+const static std::string MIN_LIST_FLT =
+    "\nSAILFISH_KERNEL static float"
+    "\nminFltScalar(float* a, int from, int n, float best)"
+    "\n{"
+    "\n    int i;"
+    "\n    for (i = from; i < n; i++)"
+    "\n        if (a[i] < best)"
+    "\n            best = a[i];"
+    "\n    return best;"
+    "\n}"
+    "\n"
+    "\n#ifdef SAILFISH_X86"
+    "\n__attribute__((target(\"sse4.1\"))) SAILFISH_KERNEL static float"
+    "\nminFltSse(float* a, int n)"
+    "\n{"
+    "\n    __m128 best;"
+    "\n    float lanes[4];"
+    "\n    int i;"
+    "\n    if (n < 4)"
+    "\n        return minFltScalar(a, 0, n, a[0]);"
+    "\n"
+    "\n    best = _mm_loadu_ps(a);"
+    "\n    for (i = 4; i + 4 <= n; i += 4)"
+    "\n        best = _mm_min_ps(best, _mm_loadu_ps(a + i));"
+    "\n    _mm_storeu_ps(lanes, best);"
+    "\n    return minFltScalar(lanes, 1, 4, minFltScalar(a, i, n, lanes[0]));"
+    "\n}"
+    "\n"
+    "\n__attribute__((target(\"avx2\"))) SAILFISH_KERNEL static float"
+    "\nminFltAvx(float* a, int n)"
+    "\n{"
+    "\n    __m256 best;"
+    "\n    float lanes[8];"
+    "\n    int i;"
+    "\n    if (n < 8)"
+    "\n        return minFltScalar(a, 0, n, a[0]);"
+    "\n"
+    "\n    best = _mm256_loadu_ps(a);"
+    "\n    for (i = 8; i + 8 <= n; i += 8)"
+    "\n        best = _mm256_min_ps(best, _mm256_loadu_ps(a + i));"
+    "\n    _mm256_storeu_ps(lanes, best);"
+    "\n    return minFltScalar(lanes, 1, 8, minFltScalar(a, i, n, lanes[0]));"
+    "\n}"
+    "\n#endif"
+    "\n"
+    "\nfloat"
+    "\nminListFlt(float* a)"
+    "\n{"
+    "\n    int n = len(a);"
+    "\n    if (n == 0)"
+    "\n        return 0;"
+    "\n#ifdef SAILFISH_X86"
+    "\n    if (simdLevel() == 2)"
+    "\n        return minFltAvx(a, n);"
+    "\n    if (simdLevel() == 1)"
+    "\n        return minFltSse(a, n);"
+    "\n#endif"
+    "\n    return minFltScalar(a, 1, n, a[0]);"
+    "\n}\n";
+
+const static std::string MAX_LIST_INT =
+    "\nSAILFISH_KERNEL static int"
+    "\nmaxIntScalar(int* a, int from, int n, int best)"
+    "\n{"
+    "\n    int i;"
+    "\n    for (i = from; i < n; i++)"
+    "\n        if (a[i] > best)"
+    "\n            best = a[i];"
+    "\n    return best;"
+    "\n}"
+    "\n"
+    "\n#ifdef SAILFISH_X86"
+    "\n__attribute__((target(\"sse4.1\"))) SAILFISH_KERNEL static int"
+    "\nmaxIntSse(int* a, int n)"
+    "\n{"
+    "\n    __m128i best;"
+    "\n    int lanes[4];"
+    "\n    int i;"
+    "\n    if (n < 4)"
+    "\n        return maxIntScalar(a, 0, n, a[0]);"
+    "\n"
+    "\n    best = _mm_loadu_si128((__m128i*)(a));"
+    "\n    for (i = 4; i + 4 <= n; i += 4)"
+    "\n        best = _mm_max_epi32(best, _mm_loadu_si128((__m128i*)(a + i)));"
+    "\n    _mm_storeu_si128((__m128i*)lanes, best);"
+    "\n    return maxIntScalar(lanes, 1, 4, maxIntScalar(a, i, n, lanes[0]));"
+    "\n}"
+    "\n"
+    "\n__attribute__((target(\"avx2\"))) SAILFISH_KERNEL static int"
+    "\nmaxIntAvx(int* a, int n)"
+    "\n{"
+    "\n    __m256i best;"
+    "\n    int lanes[8];"
+    "\n    int i;"
+    "\n    if (n < 8)"
+    "\n        return maxIntScalar(a, 0, n, a[0]);"
+    "\n"
+    "\n    best = _mm256_loadu_si256((__m256i*)(a));"
+    "\n    for (i = 8; i + 8 <= n; i += 8)"
+    "\n        best = _mm256_max_epi32(best, _mm256_loadu_si256((__m256i*)(a + i)));"
+    "\n    _mm256_storeu_si256((__m256i*)lanes, best);"
+    "\n    return maxIntScalar(lanes, 1, 8, maxIntScalar(a, i, n, lanes[0]));"
+    "\n}"
+    "\n#endif"
+    "\n"
+    "\nint"
+    "\nmaxListInt(int* a)"
+    "\n{"
+    "\n    int n = len(a);"
+    "\n    if (n == 0)"
+    "\n        return 0;"
+    "\n#ifdef SAILFISH_X86"
+    "\n    if (simdLevel() == 2)"
+    "\n        return maxIntAvx(a, n);"
+    "\n    if (simdLevel() == 1)"
+    "\n        return maxIntSse(a, n);"
+    "\n#endif"
+    "\n    return maxIntScalar(a, 1, n, a[0]);"
+    "\n}\n";
+
+const static std::string MAX_LIST_FLT =
+    "\nSAILFISH_KERNEL static float"
+    "\nmaxFltScalar(float* a, int from, int n, float best)"
+    "\n{"
+    "\n    int i;"
+    "\n    for (i = from; i < n; i++)"
+    "\n        if (a[i] > best)"
+    "\n            best = a[i];"
+    "\n    return best;"
+    "\n}"
+    "\n"
+    "\n#ifdef SAILFISH_X86"
+    "\n__attribute__((target(\"sse4.1\"))) SAILFISH_KERNEL static float"
+    "\nmaxFltSse(float* a, int n)"
+    "\n{"
+    "\n    __m128 best;"
+    "\n    float lanes[4];"
+    "\n    int i;"
+    "\n    if (n < 4)"
+    "\n        return maxFltScalar(a, 0, n, a[0]);"
+    "\n"
+    "\n    best = _mm_loadu_ps(a);"
+    "\n    for (i = 4; i + 4 <= n; i += 4)"
+    "\n        best = _mm_max_ps(best, _mm_loadu_ps(a + i));"
+    "\n    _mm_storeu_ps(lanes, best);"
+    "\n    return maxFltScalar(lanes, 1, 4, maxFltScalar(a, i, n, lanes[0]));"
+    "\n}"
+    "\n"
+    "\n__attribute__((target(\"avx2\"))) SAILFISH_KERNEL static float"
+    "\nmaxFltAvx(float* a, int n)"
+    "\n{"
+    "\n    __m256 best;"
+    "\n    float lanes[8];"
+    "\n    int i;"
+    "\n    if (n < 8)"
+    "\n        return maxFltScalar(a, 0, n, a[0]);"
+    "\n"
+    "\n    best = _mm256_loadu_ps(a);"
+    "\n    for (i = 8; i + 8 <= n; i += 8)"
+    "\n        best = _mm256_max_ps(best, _mm256_loadu_ps(a + i));"
+    "\n    _mm256_storeu_ps(lanes, best);"
+    "\n    return maxFltScalar(lanes, 1, 8, maxFltScalar(a, i, n, lanes[0]));"
+    "\n}"
+    "\n#endif"
+    "\n"
+    "\nfloat"
+    "\nmaxListFlt(float* a)"
+    "\n{"
+    "\n    int n = len(a);"
+    "\n    if (n == 0)"
+    "\n        return 0;"
+    "\n#ifdef SAILFISH_X86"
+    "\n    if (simdLevel() == 2)"
+    "\n        return maxFltAvx(a, n);"
+    "\n    if (simdLevel() == 1)"
+    "\n        return maxFltSse(a, n);"
+    "\n#endif"
+    "\n    return maxFltScalar(a, 1, n, a[0]);"
+    "\n}\n";
+
+const static std::string DOT_LIST_INT =
+    "\nSAILFISH_KERNEL static int"
+    "\ndotIntScalar(int* a, int* b, int from, int n)"
+    "\n{"
+    "\n    unsigned int total = 0;"
+    "\n    int i;"
+    "\n    for (i = from; i < n; i++)"
+    "\n        total += (unsigned int)a[i] * (unsigned int)b[i];"
+    "\n    return (int)total;"
+    "\n}"
+    "\n"
+    "\n#ifdef SAILFISH_X86"
+    "\n__attribute__((target(\"sse4.1\"))) SAILFISH_KERNEL static int"
+    "\ndotIntSse(int* a, int* b, int n)"
+    "\n{"
+    "\n    __m128i total = _mm_setzero_si128();"
+    "\n    int lanes[4];"
+    "\n    unsigned int result;"
+    "\n    int i;"
+    "\n    for (i = 0; i + 4 <= n; i += 4)"
+    "\n    {"
+    "\n        __m128i x = _mm_loadu_si128((__m128i*)(a + i));"
+    "\n        __m128i y = _mm_loadu_si128((__m128i*)(b + i));"
+    "\n        total = _mm_add_epi32(total, _mm_mullo_epi32(x, y));"
+    "\n    }"
+    "\n    _mm_storeu_si128((__m128i*)lanes, total);"
+    "\n    result = dotIntScalar(a, b, i, n);"
+    "\n    for (i = 0; i < 4; i++)"
+    "\n        result += (unsigned int)lanes[i];"
+    "\n    return (int)result;"
+    "\n}"
+    "\n"
+    "\n__attribute__((target(\"avx2\"))) SAILFISH_KERNEL static int"
+    "\ndotIntAvx(int* a, int* b, int n)"
+    "\n{"
+    "\n    __m256i total = _mm256_setzero_si256();"
+    "\n    int lanes[8];"
+    "\n    unsigned int result;"
+    "\n    int i;"
+    "\n    for (i = 0; i + 8 <= n; i += 8)"
+    "\n    {"
+    "\n        __m256i x = _mm256_loadu_si256((__m256i*)(a + i));"
+    "\n        __m256i y = _mm256_loadu_si256((__m256i*)(b + i));"
+    "\n        total = _mm256_add_epi32(total, _mm256_mullo_epi32(x, y));"
+    "\n    }"
+    "\n    _mm256_storeu_si256((__m256i*)lanes, total);"
+    "\n    result = dotIntScalar(a, b, i, n);"
+    "\n    for (i = 0; i < 8; i++)"
+    "\n        result += (unsigned int)lanes[i];"
+    "\n    return (int)result;"
+    "\n}"
+    "\n#endif"
+    "\n"
+    "\nint"
+    "\ndotListInt(int* a, int* b)"
+    "\n{"
+    "\n    int n = len(a) < len(b) ? len(a) : len(b);"
+    "\n#ifdef SAILFISH_X86"
+    "\n    if (simdLevel() == 2)"
+    "\n        return dotIntAvx(a, b, n);"
+    "\n    if (simdLevel() == 1)"
+    "\n        return dotIntSse(a, b, n);"
+    "\n#endif"
+    "\n    return dotIntScalar(a, b, 0, n);"
+    "\n}\n";
+
+const static std::string DOT_LIST_FLT =
+    "\nSAILFISH_KERNEL static float"
+    "\ndotFltScalar(float* a, float* b, int from, int n)"
+    "\n{"
+    "\n    float total = 0;"
+    "\n    int i;"
+    "\n    for (i = from; i < n; i++)"
+    "\n        total += a[i] * b[i];"
+    "\n    return total;"
+    "\n}"
+    "\n"
+    "\n#ifdef SAILFISH_X86"
+    "\n__attribute__((target(\"sse4.1\"))) SAILFISH_KERNEL static float"
+    "\ndotFltSse(float* a, float* b, int n)"
+    "\n{"
+    "\n    __m128 total = _mm_setzero_ps();"
+    "\n    float lanes[4];"
+    "\n    float result;"
+    "\n    int i;"
+    "\n    for (i = 0; i + 4 <= n; i += 4)"
+    "\n    {"
+    "\n        __m128 x = _mm_loadu_ps(a + i);"
+    "\n        __m128 y = _mm_loadu_ps(b + i);"
+    "\n        total = _mm_add_ps(total, _mm_mul_ps(x, y));"
+    "\n    }"
+    "\n    _mm_storeu_ps(lanes, total);"
+    "\n    result = dotFltScalar(a, b, i, n);"
+    "\n    for (i = 0; i < 4; i++)"
+    "\n        result += lanes[i];"
+    "\n    return result;"
+    "\n}"
+    "\n"
+    "\n__attribute__((target(\"avx2\"))) SAILFISH_KERNEL static float"
+    "\ndotFltAvx(float* a, float* b, int n)"
+    "\n{"
+    "\n    __m256 total = _mm256_setzero_ps();"
+    "\n    float lanes[8];"
+    "\n    float result;"
+    "\n    int i;"
+    "\n    for (i = 0; i + 8 <= n; i += 8)"
+    "\n    {"
+    "\n        __m256 x = _mm256_loadu_ps(a + i);"
+    "\n        __m256 y = _mm256_loadu_ps(b + i);"
+    "\n        total = _mm256_add_ps(total, _mm256_mul_ps(x, y));"
+    "\n    }"
+    "\n    _mm256_storeu_ps(lanes, total);"
+    "\n    result = dotFltScalar(a, b, i, n);"
+    "\n    for (i = 0; i < 8; i++)"
+    "\n        result += lanes[i];"
+    "\n    return result;"
+    "\n}"
+    "\n#endif"
+    "\n"
+    "\nfloat"
+    "\ndotListFlt(float* a, float* b)"
+    "\n{"
+    "\n    int n = len(a) < len(b) ? len(a) : len(b);"
+    "\n#ifdef SAILFISH_X86"
+    "\n    if (simdLevel() == 2)"
+    "\n        return dotFltAvx(a, b, n);"
+    "\n    if (simdLevel() == 1)"
+    "\n        return dotFltSse(a, b, n);"
+    "\n#endif"
+    "\n    return dotFltScalar(a, b, 0, n);"
+    "\n}\n";
+
+const static std::string SCALE_LIST_INT =
+    "\nSAILFISH_KERNEL static void"
+    "\nscaleIntScalar(int* a, int k, int from, int n)"
+    "\n{"
+    "\n    int i;"
+    "\n    for (i = from; i < n; i++)"
+    "\n        a[i] = (int)((unsigned int)a[i] * (unsigned int)k);"
+    "\n}"
+    "\n"
+    "\n#ifdef SAILFISH_X86"
+    "\n__attribute__((target(\"sse4.1\"))) SAILFISH_KERNEL static void"
+    "\nscaleIntSse(int* a, int k, int n)"
+    "\n{"
+    "\n    __m128i splat = _mm_set1_epi32(k);"
+    "\n    int i;"
+    "\n    for (i = 0; i + 4 <= n; i += 4)"
+    "\n    {"
+    "\n        __m128i x = _mm_loadu_si128((__m128i*)(a + i));"
+    "\n        _mm_storeu_si128((__m128i*)(a + i), _mm_mullo_epi32(x, splat));"
+    "\n    }"
+    "\n    scaleIntScalar(a, k, i, n);"
+    "\n}"
+    "\n"
+    "\n__attribute__((target(\"avx2\"))) SAILFISH_KERNEL static void"
+    "\nscaleIntAvx(int* a, int k, int n)"
+    "\n{"
+    "\n    __m256i splat = _mm256_set1_epi32(k);"
+    "\n    int i;"
+    "\n    for (i = 0; i + 8 <= n; i += 8)"
+    "\n    {"
+    "\n        __m256i x = _mm256_loadu_si256((__m256i*)(a + i));"
+    "\n        _mm256_storeu_si256((__m256i*)(a + i), _mm256_mullo_epi32(x, splat));"
+    "\n    }"
+    "\n    scaleIntScalar(a, k, i, n);"
+    "\n}"
+    "\n#endif"
+    "\n"
+    "\nint*"
+    "\nscaleListInt(int* a, int k)"
+    "\n{"
+    "\n    int n = len(a);"
+    "\n#ifdef SAILFISH_X86"
+    "\n    if (simdLevel() == 2)"
+    "\n        scaleIntAvx(a, k, n);"
+    "\n    else if (simdLevel() == 1)"
+    "\n        scaleIntSse(a, k, n);"
+    "\n    else"
+    "\n#endif"
+    "\n        scaleIntScalar(a, k, 0, n);"
+    "\n    return a;"
+    "\n}\n";
+
+const static std::string SCALE_LIST_FLT =
+    "\nSAILFISH_KERNEL static void"
+    "\nscaleFltScalar(float* a, float k, int from, int n)"
+    "\n{"
+    "\n    int i;"
+    "\n    for (i = from; i < n; i++)"
+    "\n        a[i] *= k;"
+    "\n}"
+    "\n"
+    "\n#ifdef SAILFISH_X86"
+    "\n__attribute__((target(\"sse4.1\"))) SAILFISH_KERNEL static void"
+    "\nscaleFltSse(float* a, float k, int n)"
+    "\n{"
+    "\n    __m128 splat = _mm_set1_ps(k);"
+    "\n    int i;"
+    "\n    for (i = 0; i + 4 <= n; i += 4)"
+    "\n    {"
+    "\n        __m128 x = _mm_loadu_ps(a + i);"
+    "\n        _mm_storeu_ps(a + i, _mm_mul_ps(x, splat));"
+    "\n    }"
+    "\n    scaleFltScalar(a, k, i, n);"
+    "\n}"
+    "\n"
+    "\n__attribute__((target(\"avx2\"))) SAILFISH_KERNEL static void"
+    "\nscaleFltAvx(float* a, float k, int n)"
+    "\n{"
+    "\n    __m256 splat = _mm256_set1_ps(k);"
+    "\n    int i;"
+    "\n    for (i = 0; i + 8 <= n; i += 8)"
+    "\n    {"
+    "\n        __m256 x = _mm256_loadu_ps(a + i);"
+    "\n        _mm256_storeu_ps(a + i, _mm256_mul_ps(x, splat));"
+    "\n    }"
+    "\n    scaleFltScalar(a, k, i, n);"
+    "\n}"
+    "\n#endif"
+    "\n"
+    "\nfloat*"
+    "\nscaleListFlt(float* a, float k)"
+    "\n{"
+    "\n    int n = len(a);"
+    "\n#ifdef SAILFISH_X86"
+    "\n    if (simdLevel() == 2)"
+    "\n        scaleFltAvx(a, k, n);"
+    "\n    else if (simdLevel() == 1)"
+    "\n        scaleFltSse(a, k, n);"
+    "\n    else"
+    "\n#endif"
+    "\n        scaleFltScalar(a, k, 0, n);"
+    "\n    return a;"
+    "\n}\n";
+
+const static std::string ADD_LIST_INT =
+    "\nSAILFISH_KERNEL static void"
+    "\naddIntScalar(int* a, int* b, int from, int n)"
+    "\n{"
+    "\n    int i;"
+    "\n    for (i = from; i < n; i++)"
+    "\n        a[i] = (int)((unsigned int)a[i] + (unsigned int)b[i]);"
+    "\n}"
+    "\n"
+    "\n#ifdef SAILFISH_X86"
+    "\n__attribute__((target(\"sse4.1\"))) SAILFISH_KERNEL static void"
+    "\naddIntSse(int* a, int* b, int n)"
+    "\n{"
+    "\n    int i;"
+    "\n    for (i = 0; i + 4 <= n; i += 4)"
+    "\n    {"
+    "\n        __m128i x = _mm_loadu_si128((__m128i*)(a + i));"
+    "\n        __m128i y = _mm_loadu_si128((__m128i*)(b + i));"
+    "\n        _mm_storeu_si128((__m128i*)(a + i), _mm_add_epi32(x, y));"
+    "\n    }"
+    "\n    addIntScalar(a, b, i, n);"
+    "\n}"
+    "\n"
+    "\n__attribute__((target(\"avx2\"))) SAILFISH_KERNEL static void"
+    "\naddIntAvx(int* a, int* b, int n)"
+    "\n{"
+    "\n    int i;"
+    "\n    for (i = 0; i + 8 <= n; i += 8)"
+    "\n    {"
+    "\n        __m256i x = _mm256_loadu_si256((__m256i*)(a + i));"
+    "\n        __m256i y = _mm256_loadu_si256((__m256i*)(b + i));"
+    "\n        _mm256_storeu_si256((__m256i*)(a + i), _mm256_add_epi32(x, y));"
+    "\n    }"
+    "\n    addIntScalar(a, b, i, n);"
+    "\n}"
+    "\n#endif"
+    "\n"
+    "\nint*"
+    "\naddListInt(int* a, int* b)"
+    "\n{"
+    "\n    int n = len(a) < len(b) ? len(a) : len(b);"
+    "\n#ifdef SAILFISH_X86"
+    "\n    if (simdLevel() == 2)"
+    "\n        addIntAvx(a, b, n);"
+    "\n    else if (simdLevel() == 1)"
+    "\n        addIntSse(a, b, n);"
+    "\n    else"
+    "\n#endif"
+    "\n        addIntScalar(a, b, 0, n);"
+    "\n    return a;"
+    "\n}\n";
+
+const static std::string ADD_LIST_FLT =
+    "\nSAILFISH_KERNEL static void"
+    "\naddFltScalar(float* a, float* b, int from, int n)"
+    "\n{"
+    "\n    int i;"
+    "\n    for (i = from; i < n; i++)"
+    "\n        a[i] += b[i];"
+    "\n}"
+    "\n"
+    "\n#ifdef SAILFISH_X86"
+    "\n__attribute__((target(\"sse4.1\"))) SAILFISH_KERNEL static void"
+    "\naddFltSse(float* a, float* b, int n)"
+    "\n{"
+    "\n    int i;"
+    "\n    for (i = 0; i + 4 <= n; i += 4)"
+    "\n    {"
+    "\n        __m128 x = _mm_loadu_ps(a + i);"
+    "\n        __m128 y = _mm_loadu_ps(b + i);"
+    "\n        _mm_storeu_ps(a + i, _mm_add_ps(x, y));"
+    "\n    }"
+    "\n    addFltScalar(a, b, i, n);"
+    "\n}"
+    "\n"
+    "\n__attribute__((target(\"avx2\"))) SAILFISH_KERNEL static void"
+    "\naddFltAvx(float* a, float* b, int n)"
+    "\n{"
+    "\n    int i;"
+    "\n    for (i = 0; i + 8 <= n; i += 8)"
+    "\n    {"
+    "\n        __m256 x = _mm256_loadu_ps(a + i);"
+    "\n        __m256 y = _mm256_loadu_ps(b + i);"
+    "\n        _mm256_storeu_ps(a + i, _mm256_add_ps(x, y));"
+    "\n    }"
+    "\n    addFltScalar(a, b, i, n);"
+    "\n}"
+    "\n#endif"
+    "\n"
+    "\nfloat*"
+    "\naddListFlt(float* a, float* b)"
+    "\n{"
+    "\n    int n = len(a) < len(b) ? len(a) : len(b);"
+    "\n#ifdef SAILFISH_X86"
+    "\n    if (simdLevel() == 2)"
+    "\n        addFltAvx(a, b, n);"
+    "\n    else if (simdLevel() == 1)"
+    "\n        addFltSse(a, b, n);"
+    "\n    else"
+    "\n#endif"
+    "\n        addFltScalar(a, b, 0, n);"
+    "\n    return a;"
+    "\n}\n";
+
+const static std::string FILL_LIST_INT =
+    "\nSAILFISH_KERNEL static void"
+    "\nfillIntScalar(int* a, int value, int from, int n)"
+    "\n{"
+    "\n    int i;"
+    "\n    for (i = from; i < n; i++)"
+    "\n        a[i] = value;"
+    "\n}"
+    "\n"
+    "\n#ifdef SAILFISH_X86"
+    "\n__attribute__((target(\"sse4.1\"))) SAILFISH_KERNEL static void"
+    "\nfillIntSse(int* a, int value, int n)"
+    "\n{"
+    "\n    __m128i splat = _mm_set1_epi32(value);"
+    "\n    int i;"
+    "\n    for (i = 0; i + 4 <= n; i += 4)"
+    "\n        _mm_storeu_si128((__m128i*)(a + i), splat);"
+    "\n    fillIntScalar(a, value, i, n);"
+    "\n}"
+    "\n"
+    "\n__attribute__((target(\"avx2\"))) SAILFISH_KERNEL static void"
+    "\nfillIntAvx(int* a, int value, int n)"
+    "\n{"
+    "\n    __m256i splat = _mm256_set1_epi32(value);"
+    "\n    int i;"
+    "\n    for (i = 0; i + 8 <= n; i += 8)"
+    "\n        _mm256_storeu_si256((__m256i*)(a + i), splat);"
+    "\n    fillIntScalar(a, value, i, n);"
+    "\n}"
+    "\n#endif"
+    "\n"
+    "\nint*"
+    "\nfillListInt(int* a, int value)"
+    "\n{"
+    "\n    int n = len(a);"
+    "\n#ifdef SAILFISH_X86"
+    "\n    if (simdLevel() == 2)"
+    "\n        fillIntAvx(a, value, n);"
+    "\n    else if (simdLevel() == 1)"
+    "\n        fillIntSse(a, value, n);"
+    "\n    else"
+    "\n#endif"
+    "\n        fillIntScalar(a, value, 0, n);"
+    "\n    return a;"
+    "\n}\n";
+
+const static std::string FILL_LIST_FLT =
+    "\nSAILFISH_KERNEL static void"
+    "\nfillFltScalar(float* a, float value, int from, int n)"
+    "\n{"
+    "\n    int i;"
+    "\n    for (i = from; i < n; i++)"
+    "\n        a[i] = value;"
+    "\n}"
+    "\n"
+    "\n#ifdef SAILFISH_X86"
+    "\n__attribute__((target(\"sse4.1\"))) SAILFISH_KERNEL static void"
+    "\nfillFltSse(float* a, float value, int n)"
+    "\n{"
+    "\n    __m128 splat = _mm_set1_ps(value);"
+    "\n    int i;"
+    "\n    for (i = 0; i + 4 <= n; i += 4)"
+    "\n        _mm_storeu_ps(a + i, splat);"
+    "\n    fillFltScalar(a, value, i, n);"
+    "\n}"
+    "\n"
+    "\n__attribute__((target(\"avx2\"))) SAILFISH_KERNEL static void"
+    "\nfillFltAvx(float* a, float value, int n)"
+    "\n{"
+    "\n    __m256 splat = _mm256_set1_ps(value);"
+    "\n    int i;"
+    "\n    for (i = 0; i + 8 <= n; i += 8)"
+    "\n        _mm256_storeu_ps(a + i, splat);"
+    "\n    fillFltScalar(a, value, i, n);"
+    "\n}"
+    "\n#endif"
+    "\n"
+    "\nfloat*"
+    "\nfillListFlt(float* a, float value)"
+    "\n{"
+    "\n    int n = len(a);"
+    "\n#ifdef SAILFISH_X86"
+    "\n    if (simdLevel() == 2)"
+    "\n        fillFltAvx(a, value, n);"
+    "\n    else if (simdLevel() == 1)"
+    "\n        fillFltSse(a, value, n);"
+    "\n    else"
+    "\n#endif"
+    "\n        fillFltScalar(a, value, 0, n);"
+    "\n    return a;"
+    "\n}\n";
+
+// every kernel, for the precompiled runtime
+std::string getKernelsStdLibC();
+
+// the kernels the C of a program calls, or nothing when it calls none
+std::string getKernelsStdLibC(const std::string& program);
+std::string getKernelsStdLibCDeclarations();
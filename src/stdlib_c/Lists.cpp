@@ -6,10 +6,21 @@
 std::string
 getListsStdLibC()
 {
-    return APPEND_LIST_INT + APPEND_LIST_STR + APPEND_LIST_BOOL +
-           APPEND_LIST_FLT + DELETE_AT_INDEX_INT + DELETE_AT_INDEX_Flt +
-           DELETE_AT_INDEX_Bool + DELETE_AT_INDEX_STR + GET_AT_INDEX_INT +
+    return LIST_HEADER_FUNCTIONS + APPEND_LIST_INT + APPEND_LIST_STR +
+           APPEND_LIST_BOOL + APPEND_LIST_FLT + PUSH_LIST_INT + PUSH_LIST_STR +
+           PUSH_LIST_BOOL + PUSH_LIST_FLT + EXTEND_LIST_INT + EXTEND_LIST_STR +
+           EXTEND_LIST_BOOL + EXTEND_LIST_FLT + DELETE_AT_INDEX_INT +
+           DELETE_AT_INDEX_Flt + DELETE_AT_INDEX_Bool + DELETE_AT_INDEX_STR +
+           REMOVE_AT_INDEX_INT + REMOVE_AT_INDEX_STR + REMOVE_AT_INDEX_BOOL +
+           REMOVE_AT_INDEX_FLT + REMOVE_RANGE_INT + REMOVE_RANGE_STR +
+           REMOVE_RANGE_BOOL + REMOVE_RANGE_FLT + GET_AT_INDEX_INT +
            GET_AT_INDEX_FLT + GET_AT_INDEX_STR + GET_AT_INDEX_BOOL +
            SET_AT_INDEX_INT + SET_AT_INDEX_BOOL + SET_AT_INDEX_FLT +
-           SET_AT_INDEX_STR + PRINT_BOOL + PRINT_FLT + PRINT_INT + PRINT_STR;
+           SET_AT_INDEX_STR;
+}
+
+std::string
+getListsStdLibCDeclarations()
+{
+    return LISTS_DECLARATIONS;
 }
\ No newline at end of file
@@ -5,124 +5,424 @@
 #pragma once
 #include <string>
 
+// Every list is a pointer to its first element with a ListHeader holding the
+// length and capacity just in front of it, so lists still index like plain C
+// arrays while the runtime can find their size in O(1) and grow them by
+// doubling. The a_size/b_size parameters of the older builtins are kept so
+// existing programs compile, but the header is what the runtime trusts.
+const static std::string LISTS_DECLARATIONS =
+    "\ntypedef struct"
+    "\n{"
+    "\n    int length;"
+    "\n    int capacity;"
+    "\n} __attribute__((aligned(16))) ListHeader;"
+    "\n#define LIST_HEADER(a) ((ListHeader*)(a)-1)"
+    "\nvoid* newList(int length, int size);"
+    "\nvoid* reserveList(void* a, int capacity, int size);"
+    "\nvoid freeList(void* a);"
+    "\nint len(void* a);"
+    "\nint* appendListInt(int* a, int* b, int a_size, int b_size);"
+    "\nchar** appendListStr(char** a, char** b, int a_size, int b_size);"
+    "\nint* appendListBool(int* a, int* b, int a_size, int b_size);"
+    "\nfloat* appendListFlt(float* a, float* b, int a_size, int b_size);"
+    "\nint* deleteAtIndexInt(int* a, int a_size, int index);"
+    "\nchar** deleteAtIndexStr(char** a, int a_size, int index);"
+    "\nint* deleteAtIndexBool(int* a, int a_size, int index);"
+    "\nfloat* deleteAtIndexFlt(float* a, int a_size, int index);"
+    "\nint* pushListInt(int* a, int a_size, int value);"
+    "\nchar** pushListStr(char** a, int a_size, char* value);"
+    "\nint* pushListBool(int* a, int a_size, int value);"
+    "\nfloat* pushListFlt(float* a, int a_size, float value);"
+    "\nint* extendListInt(int* a, int* b, int a_size, int b_size);"
+    "\nchar** extendListStr(char** a, char** b, int a_size, int b_size);"
+    "\nint* extendListBool(int* a, int* b, int a_size, int b_size);"
+    "\nfloat* extendListFlt(float* a, float* b, int a_size, int b_size);"
+    "\nint* removeAtIndexInt(int* a, int a_size, int index);"
+    "\nchar** removeAtIndexStr(char** a, int a_size, int index);"
+    "\nint* removeAtIndexBool(int* a, int a_size, int index);"
+    "\nfloat* removeAtIndexFlt(float* a, int a_size, int index);"
+    "\nint* removeRangeInt(int* a, int a_size, int index, int count);"
+    "\nchar** removeRangeStr(char** a, int a_size, int index, int count);"
+    "\nint* removeRangeBool(int* a, int a_size, int index, int count);"
+    "\nfloat* removeRangeFlt(float* a, int a_size, int index, int count);"
+    "\nint getAtIndexInt(int* a, int index);"
+    "\nint getAtIndexBool(int* a, int index);"
+    "\nchar* getAtIndexStr(char** a, int index);"
+    "\nfloat getAtIndexFlt(float* a, int index);"
+    "\nint* setAtIndexInt(int* a, int index, int value);"
+    "\nint* setAtIndexBool(int* a, int index, int value);"
+    "\nfloat* setAtIndexFlt(float* a, int index, float value);"
+    "\nchar** setAtIndexStr(char** a, int index, char* value);"
+    "\n";
+
+const static std::string LIST_HEADER_FUNCTIONS =
+    "\nvoid*"
+    "\nnewList(int length, int size)"
+    "\n{"
+    "\n    ListHeader* header ="
+    "\n        sfAlloc(sizeof(ListHeader) + (size_t)length * size);"
+    "\n    header->length = length;"
+    "\n    header->capacity = length;"
+    "\n    return header + 1;"
+    "\n}"
+    "\n"
+    "\nvoid*"
+    "\nreserveList(void* a, int capacity, int size)"
+    "\n{"
+    "\n    ListHeader* header;"
+    "\n    size_t bytes;"
+    "\n    int grown;"
+    "\n"
+    "\n    if (a == NULL)"
+    "\n    {"
+    "\n        a = newList(capacity, size);"
+    "\n        LIST_HEADER(a)->length = 0;"
+    "\n        return a;"
+    "\n    }"
+    "\n"
+    "\n    header = LIST_HEADER(a);"
+    "\n    if (header->capacity >= capacity)"
+    "\n        return a;"
+    "\n"
+    "\n    grown = header->capacity * 2;"
+    "\n    if (grown < capacity)"
+    "\n        grown = capacity;"
+    "\n    bytes = sizeof(ListHeader) + (size_t)header->capacity * size;"
+    "\n    header = sfRealloc(header, bytes, sizeof(ListHeader) + (size_t)grown * size);"
+    "\n    header->capacity = grown;"
+    "\n    return header + 1;"
+    "\n}"
+    "\n"
+    "\nvoid"
+    "\nfreeList(void* a)"
+    "\n{"
+    "\n    if (a != NULL)"
+    "\n        sfFree(LIST_HEADER(a));"
+    "\n}"
+    "\n"
+    "\nint"
+    "\nlen(void* a)"
+    "\n{"
+    "\n    return a == NULL ? 0 : LIST_HEADER(a)->length;"
+    "\n}"
+    "\n"
+    "\nstatic void"
+    "\ncheckIndex(void* a, int index)"
+    "\n{"
+    "\n    if (index < 0 || index >= len(a))"
+    "\n    {"
+    "\n        flushOutput();"
+    "\n        fprintf(stderr,"
+    "\n                \"List index %d is out of bounds for length %d.\\n\","
+    "\n                index, len(a));"
+    "\n        exit(1);"
+    "\n    }"
+    "\n}\n";
+
 const static std::string APPEND_LIST_INT =
     "\nint*"
     "\nappendListInt(int* a, int* b, int a_size, int b_size)"
     "\n{"
-    "\n    int* combined = malloc((a_size + b_size) * sizeof(int));"
-    "\n    memcpy(combined,     a, a_size * sizeof(int));"
-    "\n    memcpy(combined + a_size, b, b_size * sizeof(int));"
-    "\n    free(a);"
-    "\n    free(b);"
-    "\n    return combined;"
+    "\n    int self = a == b;"
+    "\n    a = extendListInt(a, b, a_size, b_size);"
+    "\n    if (!self)"
+    "\n        freeList(b);"
+    "\n    return a;"
     "\n}\n";
 
 const static std::string APPEND_LIST_STR =
     "\nchar**"
     "\nappendListStr(char** a, char** b, int a_size, int b_size)"
     "\n{"
-    "\n    char** combined = malloc((a_size + b_size) * sizeof(char*));"
-    "\n    memcpy(combined,     a, a_size * sizeof(char*));"
-    "\n    memcpy(combined + a_size, b, b_size * sizeof(char*));"
-    "\n    free(a);"
-    "\n    free(b);"
-    "\n    return combined;"
+    "\n    int self = a == b;"
+    "\n    a = extendListStr(a, b, a_size, b_size);"
+    "\n    if (!self)"
+    "\n        freeList(b);"
+    "\n    return a;"
     "\n}\n";
 
 const static std::string APPEND_LIST_BOOL =
     "\nint*"
     "\nappendListBool(int* a, int* b, int a_size, int b_size)"
     "\n{"
-    "\n    int* combined = malloc((a_size + b_size) * sizeof(int));"
-    "\n    memcpy(combined,     a, a_size * sizeof(int));"
-    "\n    memcpy(combined + a_size, b, b_size * sizeof(int));"
-    "\n    free(a);"
-    "\n    free(b);"
-    "\n    return combined;"
+    "\n    int self = a == b;"
+    "\n    a = extendListBool(a, b, a_size, b_size);"
+    "\n    if (!self)"
+    "\n        freeList(b);"
+    "\n    return a;"
     "\n}\n";
 
 const static std::string APPEND_LIST_FLT =
     "\nfloat*"
     "\nappendListFlt(float* a, float* b, int a_size, int b_size)"
     "\n{"
-    "\n    float* combined = malloc((a_size + b_size) * sizeof(float));"
-    "\n    memcpy(combined,     a, a_size * sizeof(float));"
-    "\n    memcpy(combined + a_size, b, b_size * sizeof(float));"
-    "\n    free(a);"
-    "\n    free(b);"
-    "\n    return combined;"
+    "\n    int self = a == b;"
+    "\n    a = extendListFlt(a, b, a_size, b_size);"
+    "\n    if (!self)"
+    "\n        freeList(b);"
+    "\n    return a;"
     "\n}\n";
 
 const static std::string DELETE_AT_INDEX_INT =
     "\nint*"
     "\ndeleteAtIndexInt(int* a, int a_size, int index)"
     "\n{"
-    "\n    if (a_size == 0 || a_size - 1 < index || index < 0)"
-    "\n        return a;"
-    "\n"
-    "\n    int* downsize = malloc((a_size - 1) * sizeof(int));"
-    "\n    for (int i = 0; i < index; i ++)"
-    "\n        downsize[i] = a[i];"
-    "\n    for (int i = index + 1; i < a_size; i ++)"
-    "\n        downsize[i-1] = a[i];"
-    "\n    return downsize;"
+    "\n    return removeAtIndexInt(a, a_size, index);"
     "\n}\n";
 
 const static std::string DELETE_AT_INDEX_STR =
     "\nchar**"
     "\ndeleteAtIndexStr(char** a, int a_size, int index)"
     "\n{"
-    "\n    if (a_size == 0 || a_size - 1 < index || index < 0)"
-    "\n        return a;"
-    "\n"
-    "\n    char** downsize = malloc((a_size - 1) * sizeof(char*));"
-    "\n    for (int i = 0; i < index; i ++)"
-    "\n        downsize[i] = a[i];"
-    "\n    for (int i = index + 1; i < a_size; i ++)"
-    "\n        downsize[i-1] = a[i];"
-    "\n    return downsize;"
+    "\n    return removeAtIndexStr(a, a_size, index);"
     "\n}\n";
 
 const static std::string DELETE_AT_INDEX_Bool =
     "\nint*"
     "\ndeleteAtIndexBool(int* a, int a_size, int index)"
     "\n{"
-    "\n    if (a_size == 0 || a_size - 1 < index || index < 0)"
-    "\n        return a;"
-    "\n"
-    "\n    int* downsize = malloc((a_size - 1) * sizeof(int));"
-    "\n    for (int i = 0; i < index; i ++)"
-    "\n        downsize[i] = a[i];"
-    "\n    for (int i = index + 1; i < a_size; i ++)"
-    "\n        downsize[i-1] = a[i];"
-    "\n    return downsize;"
+    "\n    return removeAtIndexBool(a, a_size, index);"
     "\n}\n";
 
 const static std::string DELETE_AT_INDEX_Flt =
     "\nfloat*"
     "\ndeleteAtIndexFlt(float* a, int a_size, int index)"
     "\n{"
-    "\n    if (a_size == 0 || a_size - 1 < index || index < 0)"
+    "\n    return removeAtIndexFlt(a, a_size, index);"
+    "\n}\n";
+
+const static std::string PUSH_LIST_INT =
+    "\nint*"
+    "\npushListInt(int* a, int a_size, int value)"
+    "\n{"
+    "\n    int length = len(a);"
+    "\n    a = reserveList(a, length + 1, sizeof(int));"
+    "\n    a[length] = value;"
+    "\n    LIST_HEADER(a)->length = length + 1;"
+    "\n    return a;"
+    "\n}\n";
+
+const static std::string PUSH_LIST_STR =
+    "\nchar**"
+    "\npushListStr(char** a, int a_size, char* value)"
+    "\n{"
+    "\n    int length = len(a);"
+    "\n    a = reserveList(a, length + 1, sizeof(char*));"
+    "\n    a[length] = value;"
+    "\n    LIST_HEADER(a)->length = length + 1;"
+    "\n    return a;"
+    "\n}\n";
+
+const static std::string PUSH_LIST_BOOL =
+    "\nint*"
+    "\npushListBool(int* a, int a_size, int value)"
+    "\n{"
+    "\n    int length = len(a);"
+    "\n    a = reserveList(a, length + 1, sizeof(int));"
+    "\n    a[length] = value;"
+    "\n    LIST_HEADER(a)->length = length + 1;"
+    "\n    return a;"
+    "\n}\n";
+
+const static std::string PUSH_LIST_FLT =
+    "\nfloat*"
+    "\npushListFlt(float* a, int a_size, float value)"
+    "\n{"
+    "\n    int length = len(a);"
+    "\n    a = reserveList(a, length + 1, sizeof(float));"
+    "\n    a[length] = value;"
+    "\n    LIST_HEADER(a)->length = length + 1;"
+    "\n    return a;"
+    "\n}\n";
+
+const static std::string EXTEND_LIST_INT =
+    "\nint*"
+    "\nextendListInt(int* a, int* b, int a_size, int b_size)"
+    "\n{"
+    "\n    int length = len(a);"
+    "\n    int added = len(b);"
+    "\n    int self = a == b;"
+    "\n    // extending a list with itself copies from where it moved to"
+    "\n    a = reserveList(a, length + added, sizeof(int));"
+    "\n    memcpy(a + length, self ? a : b, added * sizeof(int));"
+    "\n    LIST_HEADER(a)->length = length + added;"
+    "\n    return a;"
+    "\n}\n";
+
+const static std::string EXTEND_LIST_STR =
+    "\nchar**"
+    "\nextendListStr(char** a, char** b, int a_size, int b_size)"
+    "\n{"
+    "\n    int length = len(a);"
+    "\n    int added = len(b);"
+    "\n    int self = a == b;"
+    "\n    a = reserveList(a, length + added, sizeof(char*));"
+    "\n    memcpy(a + length, self ? a : b, added * sizeof(char*));"
+    "\n    LIST_HEADER(a)->length = length + added;"
+    "\n    return a;"
+    "\n}\n";
+
+const static std::string EXTEND_LIST_BOOL =
+    "\nint*"
+    "\nextendListBool(int* a, int* b, int a_size, int b_size)"
+    "\n{"
+    "\n    int length = len(a);"
+    "\n    int added = len(b);"
+    "\n    int self = a == b;"
+    "\n    a = reserveList(a, length + added, sizeof(int));"
+    "\n    memcpy(a + length, self ? a : b, added * sizeof(int));"
+    "\n    LIST_HEADER(a)->length = length + added;"
+    "\n    return a;"
+    "\n}\n";
+
+const static std::string EXTEND_LIST_FLT =
+    "\nfloat*"
+    "\nextendListFlt(float* a, float* b, int a_size, int b_size)"
+    "\n{"
+    "\n    int length = len(a);"
+    "\n    int added = len(b);"
+    "\n    int self = a == b;"
+    "\n    a = reserveList(a, length + added, sizeof(float));"
+    "\n    memcpy(a + length, self ? a : b, added * sizeof(float));"
+    "\n    LIST_HEADER(a)->length = length + added;"
+    "\n    return a;"
+    "\n}\n";
+
+// In place removal, shifting the tail down and keeping the allocation so that
+// later pushes reuse it.
+const static std::string REMOVE_AT_INDEX_INT =
+    "\nint*"
+    "\nremoveAtIndexInt(int* a, int a_size, int index)"
+    "\n{"
+    "\n    int length = len(a);"
+    "\n    if (length == 0 || length - 1 < index || index < 0)"
     "\n        return a;"
     "\n"
-    "\n    float* downsize = malloc((a_size - 1) * sizeof(float));"
-    "\n    for (int i = 0; i < index; i ++)"
-    "\n        downsize[i] = a[i];"
-    "\n    for (int i = index + 1; i < a_size; i ++)"
-    "\n        downsize[i-1] = a[i];"
-    "\n    return downsize;"
+    "\n    memmove(a + index, a + index + 1,"
+    "\n            (length - index - 1) * sizeof(int));"
+    "\n    LIST_HEADER(a)->length = length - 1;"
+    "\n    return a;"
     "\n}\n";
 
-const static std::string GET_AT_INDEX_INT = "\nint"
-                                            "\ngetAtIndexInt(int* a, int index)"
-                                            "\n{"
-                                            "\n    return a[index];"
-                                            "\n}\n";
+const static std::string REMOVE_AT_INDEX_STR =
+    "\nchar**"
+    "\nremoveAtIndexStr(char** a, int a_size, int index)"
+    "\n{"
+    "\n    int length = len(a);"
+    "\n    if (length == 0 || length - 1 < index || index < 0)"
+    "\n        return a;"
+    "\n"
+    "\n    memmove(a + index, a + index + 1,"
+    "\n            (length - index - 1) * sizeof(char*));"
+    "\n    LIST_HEADER(a)->length = length - 1;"
+    "\n    return a;"
+    "\n}\n";
+
+const static std::string REMOVE_AT_INDEX_BOOL =
+    "\nint*"
+    "\nremoveAtIndexBool(int* a, int a_size, int index)"
+    "\n{"
+    "\n    int length = len(a);"
+    "\n    if (length == 0 || length - 1 < index || index < 0)"
+    "\n        return a;"
+    "\n"
+    "\n    memmove(a + index, a + index + 1,"
+    "\n            (length - index - 1) * sizeof(int));"
+    "\n    LIST_HEADER(a)->length = length - 1;"
+    "\n    return a;"
+    "\n}\n";
+
+const static std::string REMOVE_AT_INDEX_FLT =
+    "\nfloat*"
+    "\nremoveAtIndexFlt(float* a, int a_size, int index)"
+    "\n{"
+    "\n    int length = len(a);"
+    "\n    if (length == 0 || length - 1 < index || index < 0)"
+    "\n        return a;"
+    "\n"
+    "\n    memmove(a + index, a + index + 1,"
+    "\n            (length - index - 1) * sizeof(float));"
+    "\n    LIST_HEADER(a)->length = length - 1;"
+    "\n    return a;"
+    "\n}\n";
+
+const static std::string REMOVE_RANGE_INT =
+    "\nint*"
+    "\nremoveRangeInt(int* a, int a_size, int index, int count)"
+    "\n{"
+    "\n    int length = len(a);"
+    "\n    if (index < 0 || count <= 0 || index >= length)"
+    "\n        return a;"
+    "\n    if (count > length - index)"
+    "\n        count = length - index;"
+    "\n"
+    "\n    memmove(a + index, a + index + count,"
+    "\n            (length - index - count) * sizeof(int));"
+    "\n    LIST_HEADER(a)->length = length - count;"
+    "\n    return a;"
+    "\n}\n";
+
+const static std::string REMOVE_RANGE_STR =
+    "\nchar**"
+    "\nremoveRangeStr(char** a, int a_size, int index, int count)"
+    "\n{"
+    "\n    int length = len(a);"
+    "\n    if (index < 0 || count <= 0 || index >= length)"
+    "\n        return a;"
+    "\n    if (count > length - index)"
+    "\n        count = length - index;"
+    "\n"
+    "\n    memmove(a + index, a + index + count,"
+    "\n            (length - index - count) * sizeof(char*));"
+    "\n    LIST_HEADER(a)->length = length - count;"
+    "\n    return a;"
+    "\n}\n";
+
+const static std::string REMOVE_RANGE_BOOL =
+    "\nint*"
+    "\nremoveRangeBool(int* a, int a_size, int index, int count)"
+    "\n{"
+    "\n    int length = len(a);"
+    "\n    if (index < 0 || count <= 0 || index >= length)"
+    "\n        return a;"
+    "\n    if (count > length - index)"
+    "\n        count = length - index;"
+    "\n"
+    "\n    memmove(a + index, a + index + count,"
+    "\n            (length - index - count) * sizeof(int));"
+    "\n    LIST_HEADER(a)->length = length - count;"
+    "\n    return a;"
+    "\n}\n";
+
+const static std::string REMOVE_RANGE_FLT =
+    "\nfloat*"
+    "\nremoveRangeFlt(float* a, int a_size, int index, int count)"
+    "\n{"
+    "\n    int length = len(a);"
+    "\n    if (index < 0 || count <= 0 || index >= length)"
+    "\n        return a;"
+    "\n    if (count > length - index)"
+    "\n        count = length - index;"
+    "\n"
+    "\n    memmove(a + index, a + index + count,"
+    "\n            (length - index - count) * sizeof(float));"
+    "\n    LIST_HEADER(a)->length = length - count;"
+    "\n    return a;"
+    "\n}\n";
+
+const static std::string GET_AT_INDEX_INT =
+    "\nint"
+    "\ngetAtIndexInt(int* a, int index)"
+    "\n{"
+    "\n    checkIndex(a, index);"
+    "\n    return a[index];"
+    "\n}\n";
 
 const static std::string GET_AT_INDEX_BOOL =
     "\nint"
     "\ngetAtIndexBool(int* a, int index)"
     "\n{"
+    "\n    checkIndex(a, index);"
     "\n    return a[index];"
     "\n}\n";
 
@@ -130,6 +430,7 @@ const static std::string GET_AT_INDEX_STR =
     "\nchar*"
     "\ngetAtIndexStr(char** a, int index)"
     "\n{"
+    "\n    checkIndex(a, index);"
     "\n    return a[index];"
     "\n}\n";
 
@@ -137,6 +438,7 @@ const static std::string GET_AT_INDEX_FLT =
     "\nfloat"
     "\ngetAtIndexFlt(float* a, int index)"
     "\n{"
+    "\n    checkIndex(a, index);"
     "\n    return a[index];"
     "\n}\n";
 
@@ -144,6 +446,7 @@ const static std::string SET_AT_INDEX_INT =
     "\nint*"
     "\nsetAtIndexInt(int* a, int index, int value)"
     "\n{"
+    "\n    checkIndex(a, index);"
     "\n    a[index] = value;"
     "\n    return a;"
     "\n}\n";
@@ -152,6 +455,7 @@ const static std::string SET_AT_INDEX_BOOL =
     "\nint*"
     "\nsetAtIndexBool(int* a, int index, int value)"
     "\n{"
+    "\n    checkIndex(a, index);"
     "\n    a[index] = value;"
     "\n    return a;"
     "\n}\n";
@@ -160,6 +464,7 @@ const static std::string SET_AT_INDEX_FLT =
     "\nfloat*"
     "\nsetAtIndexFlt(float* a, int index, float value)"
     "\n{"
+    "\n    checkIndex(a, index);"
     "\n    a[index] = value;"
     "\n    return a;"
     "\n}\n";
@@ -168,35 +473,10 @@ const static std::string SET_AT_INDEX_STR =
     "\nchar**"
     "\nsetAtIndexStr(char** a, int index, char* value)"
     "\n{"
+    "\n    checkIndex(a, index);"
     "\n    a[index] = value;"
     "\n    return a;"
     "\n}\n";
 
-const static std::string PRINT_INT = "\nvoid"
-                                     "\nprintInt(int i)"
-                                     "\n{"
-                                     "\n    printf(\"%d\\n\", i);"
-                                     "\n}\n";
-
-const static std::string PRINT_STR = "\nvoid"
-                                     "\nprintStr(char* s)"
-                                     "\n{"
-                                     "\n    printf(\"%s\\n\", s);"
-                                     "\n}\n";
-
-const static std::string PRINT_BOOL = "\nvoid"
-                                      "\nprintBool(int i)"
-                                      "\n{"
-                                      "\n    if (i == 0)"
-                                      "\n       printf(\"false\\n\");"
-                                      "\n    else"
-                                      "\n       printf(\"true\\n\");"
-                                      "\n}\n";
-
-const static std::string PRINT_FLT = "\nvoid"
-                                     "\nprintFlt(float f)"
-                                     "\n{"
-                                     "\n    printf(\"%f\\n\", f);"
-                                     "\n}\n";
-
-std::string getListsStdLibC();
\ No newline at end of file
+std::string getListsStdLibC();
+std::string getListsStdLibCDeclarations();
\ No newline at end of file
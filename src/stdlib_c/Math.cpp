@@ -0,0 +1,16 @@
+/*
+ * Robert Durst 2019
+ * Sailfish Programming Language
+ */
+#include "Math.h"
+std::string
+getMathStdLibC()
+{
+    return POW_INT + POW_FLT;
+}
+
+std::string
+getMathStdLibCDeclarations()
+{
+    return MATH_DECLARATIONS;
+}
@@ -0,0 +1,65 @@
+/*
+ * Robert Durst 2019
+ * Sailfish Programming Language
+ */
+#pragma once
+#include <string>
+
+// Integer powers for the ** operator, by repeated squaring. Powers of flt with
+// a fractional exponent go through pow from math.h, which needs -lm.
+const static std::string MATH_DECLARATIONS =
+    "\n#include <math.h>"
+    "\nint powInt(int base, int exponent);"
+    "\nfloat powFlt(float base, int exponent);\n";
+
+const static std::string POW_INT =
+    "\n/* ints wrap on overflow like the rest of the int arithmetic; a negative"
+    "\n   exponent truncates 1 / base ** -exponent towards zero */"
+    "\nint"
+    "\npowInt(int base, int exponent)"
+    "\n{"
+    "\n    unsigned int result = 1;"
+    "\n    unsigned int square = (unsigned int)base;"
+    "\n"
+    "\n    if (exponent < 0)"
+    "\n    {"
+    "\n        if (base == 1)"
+    "\n            return 1;"
+    "\n        if (base == -1)"
+    "\n            return (exponent & 1) ? -1 : 1;"
+    "\n        return 0;"
+    "\n    }"
+    "\n"
+    "\n    while (exponent > 0)"
+    "\n    {"
+    "\n        if (exponent & 1)"
+    "\n            result *= square;"
+    "\n        square *= square;"
+    "\n        exponent >>= 1;"
+    "\n    }"
+    "\n"
+    "\n    return (int)result;"
+    "\n}\n";
+
+const static std::string POW_FLT =
+    "\nfloat"
+    "\npowFlt(float base, int exponent)"
+    "\n{"
+    "\n    double result = 1.0;"
+    "\n    double square = base;"
+    "\n    unsigned int n = exponent < 0 ? 0u - (unsigned int)exponent"
+    "\n                                  : (unsigned int)exponent;"
+    "\n"
+    "\n    while (n > 0)"
+    "\n    {"
+    "\n        if (n & 1)"
+    "\n            result *= square;"
+    "\n        square *= square;"
+    "\n        n >>= 1;"
+    "\n    }"
+    "\n"
+    "\n    return (float)(exponent < 0 ? 1.0 / result : result);"
+    "\n}\n";
+
+std::string getMathStdLibC();
+std::string getMathStdLibCDeclarations();
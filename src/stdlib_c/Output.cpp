@@ -0,0 +1,19 @@
+/*
+ * Robert Durst 2019
+ * Sailfish Programming Language
+ */
+#include "Output.h"
+std::string
+getOutputStdLibC()
+{
+    return OUTPUT_INCLUDES + OUTPUT_BUFFER + FLUSH_OUTPUT + SET_LINE_BUFFERED +
+           WRITE_BYTES + WRITE_LINE + FORMAT_DIGITS + PRINT_INT + PRINT_FLT +
+           PRINT_STR + PRINT_BOOL + PRINT_LIST_INT + PRINT_LIST_STR +
+           PRINT_LIST_BOOL + PRINT_LIST_FLT;
+}
+
+std::string
+getOutputStdLibCDeclarations()
+{
+    return OUTPUT_DECLARATIONS;
+}
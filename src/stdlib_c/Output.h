@@ -0,0 +1,210 @@
+/*
+ * Robert Durst 2019
+ * Sailfish Programming Language
+ */
+#pragma once
+#include <string>
+
+// printInt and friends write into a buffer instead of calling printf, so a
+// program printing many lines does one write per 64KB rather than per line.
+// Ints and floats are formatted by hand, matching printf's "%d" and "%f".
+const static std::string OUTPUT_INCLUDES =
+    "\n#include <math.h>"
+    "\n#include <unistd.h>\n";
+
+const static std::string OUTPUT_DECLARATIONS =
+    "\nvoid flushOutput(void);"
+    "\nvoid setLineBuffered(int on);"
+    "\nvoid printInt(int i);"
+    "\nvoid printStr(char* s);"
+    "\nvoid printBool(int i);"
+    "\nvoid printFlt(float f);"
+    "\nvoid printListInt(int* a);"
+    "\nvoid printListStr(char** a);"
+    "\nvoid printListBool(int* a);"
+    "\nvoid printListFlt(float* a);\n";
+
+const static std::string OUTPUT_BUFFER =
+    "\n/* Everything printed goes through one buffer, flushed when it fills and at"
+    "\n   exit. Line buffered output also flushes after every line; it is the"
+    "\n   default when stdout is a terminal. */"
+    "\n#define OUTPUT_BUFFER_SIZE 65536"
+    "\n"
+    "\nstatic char outputBuffer[OUTPUT_BUFFER_SIZE];"
+    "\nstatic int outputLength = 0;"
+    "\nstatic int outputLineBuffered = -1;"
+    "\nstatic int outputStarted = 0;\n";
+
+const static std::string FLUSH_OUTPUT =
+    "\nvoid"
+    "\nflushOutput(void)"
+    "\n{"
+    "\n    if (outputLength > 0)"
+    "\n        fwrite(outputBuffer, 1, outputLength, stdout);"
+    "\n    outputLength = 0;"
+    "\n    fflush(stdout);"
+    "\n}\n";
+
+const static std::string SET_LINE_BUFFERED =
+    "\nvoid"
+    "\nsetLineBuffered(int on)"
+    "\n{"
+    "\n    outputLineBuffered = on;"
+    "\n}\n";
+
+const static std::string WRITE_BYTES =
+    "\nstatic void"
+    "\nwriteBytes(const char* s, int n)"
+    "\n{"
+    "\n    if (!outputStarted)"
+    "\n    {"
+    "\n        outputStarted = 1;"
+    "\n        if (outputLineBuffered == -1)"
+    "\n            outputLineBuffered = isatty(fileno(stdout));"
+    "\n        atexit(flushOutput);"
+    "\n    }"
+    "\n"
+    "\n    if (n > OUTPUT_BUFFER_SIZE - outputLength)"
+    "\n    {"
+    "\n        flushOutput();"
+    "\n        if (n > OUTPUT_BUFFER_SIZE)"
+    "\n        {"
+    "\n            fwrite(s, 1, n, stdout);"
+    "\n            return;"
+    "\n        }"
+    "\n    }"
+    "\n    memcpy(outputBuffer + outputLength, s, n);"
+    "\n    outputLength += n;"
+    "\n}\n";
+
+const static std::string WRITE_LINE =
+    "\nstatic void"
+    "\nwriteLine(const char* s, int n)"
+    "\n{"
+    "\n    char newline = '\\n';"
+    "\n    writeBytes(s, n);"
+    "\n    writeBytes(&newline, 1);"
+    "\n    if (outputLineBuffered)"
+    "\n        flushOutput();"
+    "\n}\n";
+
+const static std::string FORMAT_DIGITS =
+    "\n/* writes the digits of value ending just before end, returning the start */"
+    "\nstatic char*"
+    "\nformatDigits(char* end, unsigned long long value, int minDigits)"
+    "\n{"
+    "\n    do"
+    "\n    {"
+    "\n        *--end = (char)('0' + value % 10);"
+    "\n        value /= 10;"
+    "\n        minDigits--;"
+    "\n    } while (value != 0 || minDigits > 0);"
+    "\n    return end;"
+    "\n}\n";
+
+const static std::string PRINT_INT =
+    "\nvoid"
+    "\nprintInt(int i)"
+    "\n{"
+    "\n    char text[16];"
+    "\n    unsigned int magnitude = i < 0 ? 0u - (unsigned int)i : (unsigned int)i;"
+    "\n    char* start = formatDigits(text + sizeof(text), magnitude, 1);"
+    "\n    if (i < 0)"
+    "\n        *--start = '-';"
+    "\n    writeLine(start, (int)(text + sizeof(text) - start));"
+    "\n}\n";
+
+const static std::string PRINT_FLT =
+    "\n/* Formats like printf's \"%f\". A float times 1e6 is exact in a double, so"
+    "\n   rounding the scaled value half to even gives the same six decimals as"
+    "\n   printf. Huge values, infinities and nan are left to snprintf. */"
+    "\nvoid"
+    "\nprintFlt(float f)"
+    "\n{"
+    "\n    char text[64];"
+    "\n    double scaled = (double)f * 1e6;"
+    "\n    unsigned long long units;"
+    "\n    double fraction;"
+    "\n    char* start;"
+    "\n    int negative = signbit(f) != 0;"
+    "\n"
+    "\n    if (!(f > -1e12f && f < 1e12f))"
+    "\n    {"
+    "\n        writeLine(text, snprintf(text, sizeof(text), \"%f\", f));"
+    "\n        return;"
+    "\n    }"
+    "\n"
+    "\n    if (negative)"
+    "\n        scaled = -scaled;"
+    "\n    units = (unsigned long long)scaled;"
+    "\n    fraction = scaled - (double)units;"
+    "\n    if (fraction > 0.5 || (fraction == 0.5 && units % 2 == 1))"
+    "\n        units++;"
+    "\n"
+    "\n    start = formatDigits(text + sizeof(text), units % 1000000, 6);"
+    "\n    *--start = '.';"
+    "\n    start = formatDigits(start, units / 1000000, 1);"
+    "\n    if (negative)"
+    "\n        *--start = '-';"
+    "\n    writeLine(start, (int)(text + sizeof(text) - start));"
+    "\n}\n";
+
+const static std::string PRINT_STR =
+    "\nvoid"
+    "\nprintStr(char* s)"
+    "\n{"
+    "\n    writeLine(s, (int)strlen(s));"
+    "\n}\n";
+
+const static std::string PRINT_BOOL =
+    "\nvoid"
+    "\nprintBool(int i)"
+    "\n{"
+    "\n    if (i == 0)"
+    "\n        writeLine(\"false\", 5);"
+    "\n    else"
+    "\n        writeLine(\"true\", 4);"
+    "\n}\n";
+
+const static std::string PRINT_LIST_INT =
+    "\nvoid"
+    "\nprintListInt(int* a)"
+    "\n{"
+    "\n    int n = len(a);"
+    "\n    int i;"
+    "\n    for (i = 0; i < n; i++)"
+    "\n        printInt(a[i]);"
+    "\n}\n";
+
+const static std::string PRINT_LIST_STR =
+    "\nvoid"
+    "\nprintListStr(char** a)"
+    "\n{"
+    "\n    int n = len(a);"
+    "\n    int i;"
+    "\n    for (i = 0; i < n; i++)"
+    "\n        printStr(a[i]);"
+    "\n}\n";
+
+const static std::string PRINT_LIST_BOOL =
+    "\nvoid"
+    "\nprintListBool(int* a)"
+    "\n{"
+    "\n    int n = len(a);"
+    "\n    int i;"
+    "\n    for (i = 0; i < n; i++)"
+    "\n        printBool(a[i]);"
+    "\n}\n";
+
+const static std::string PRINT_LIST_FLT =
+    "\nvoid"
+    "\nprintListFlt(float* a)"
+    "\n{"
+    "\n    int n = len(a);"
+    "\n    int i;"
+    "\n    for (i = 0; i < n; i++)"
+    "\n        printFlt(a[i]);"
+    "\n}\n";
+
+std::string getOutputStdLibC();
+std::string getOutputStdLibCDeclarations();
@@ -0,0 +1,17 @@
+/*
+ * Robert Durst 2019
+ * Sailfish Programming Language
+ */
+#include "Profile.h"
+std::string
+getProfileStdLibC()
+{
+    return PROFILE_STATE + PROFILE_NOW + COMPARE_PROFILE_SITES +
+           REPORT_PROFILE + PROFILE_ENTER + PROFILE_EXIT;
+}
+
+std::string
+getProfileStdLibCDeclarations()
+{
+    return PROFILE_DECLARATIONS;
+}
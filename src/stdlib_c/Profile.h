@@ -0,0 +1,141 @@
+/*
+ * Robert Durst 2019
+ * Sailfish Programming Language
+ */
+#pragma once
+#include <string>
+
+// Per function call counts and times for programs compiled with --instrument,
+// which gives every function a ProfileSite.
+const static std::string PROFILE_DECLARATIONS =
+    "\n#include <time.h>"
+    "\ntypedef struct ProfileSite"
+    "\n{"
+    "\n    const char* name;"
+    "\n    const char* file;"
+    "\n    int line;"
+    "\n    int active;"
+    "\n    long calls;"
+    "\n    unsigned long long inclusive;"
+    "\n    unsigned long long exclusive;"
+    "\n    struct ProfileSite* next;"
+    "\n} ProfileSite;"
+    "\nProfileSite* profileEnter(ProfileSite* site);"
+    "\nvoid profileExit(ProfileSite** site);\n";
+
+const static std::string PROFILE_STATE =
+    "\n/* Functions compiled with --instrument own a ProfileSite and call"
+    "\n   profileEnter when called and profileExit, through a cleanup attribute,"
+    "\n   when they return. The open calls are kept on a stack of their own rather"
+    "\n   than in the caller's frame, so deep recursion needs no more C stack than"
+    "\n   one pointer a call. Inclusive time counts a recursive function once, from"
+    "\n   its outermost call; exclusive time leaves out the calls it makes. The"
+    "\n   profile is printed to stderr at exit. Times are in nanoseconds of the"
+    "\n   monotonic clock. */"
+    "\ntypedef struct ProfileFrame"
+    "\n{"
+    "\n    ProfileSite* site;"
+    "\n    unsigned long long start;"
+    "\n    unsigned long long children;"
+    "\n} ProfileFrame;"
+    "\n"
+    "\nstatic ProfileSite* profileSites = NULL;"
+    "\nstatic ProfileFrame* profileStack = NULL;"
+    "\nstatic size_t profileDepth = 0;"
+    "\nstatic size_t profileCapacity = 0;\n";
+
+const static std::string PROFILE_NOW =
+    "\nstatic unsigned long long"
+    "\nprofileNow(void)"
+    "\n{"
+    "\n    struct timespec t;"
+    "\n    clock_gettime(CLOCK_MONOTONIC, &t);"
+    "\n    return (unsigned long long)t.tv_sec * 1000000000ull + t.tv_nsec;"
+    "\n}\n";
+
+const static std::string COMPARE_PROFILE_SITES =
+    "\nstatic int"
+    "\ncompareProfileSites(const void* a, const void* b)"
+    "\n{"
+    "\n    const ProfileSite* x = *(ProfileSite* const*)a;"
+    "\n    const ProfileSite* y = *(ProfileSite* const*)b;"
+    "\n    return (x->exclusive < y->exclusive) - (x->exclusive > y->exclusive);"
+    "\n}\n";
+
+const static std::string REPORT_PROFILE =
+    "\nstatic void"
+    "\nreportProfile(void)"
+    "\n{"
+    "\n    ProfileSite** sites;"
+    "\n    ProfileSite* site;"
+    "\n    size_t count = 0;"
+    "\n    size_t i;"
+    "\n"
+    "\n    for (site = profileSites; site != NULL; site = site->next)"
+    "\n        count++;"
+    "\n"
+    "\n    sites = malloc(count * sizeof(ProfileSite*));"
+    "\n    if (sites == NULL)"
+    "\n        return;"
+    "\n    for (site = profileSites, i = 0; site != NULL; site = site->next)"
+    "\n        sites[i++] = site;"
+    "\n    qsort(sites, count, sizeof(ProfileSite*), compareProfileSites);"
+    "\n"
+    "\n    fprintf(stderr, \"[profile] %-32s %12s %14s %14s  %s\\n\", \"function\","
+    "\n            \"calls\", \"inclusive ms\", \"exclusive ms\", \"defined at\");"
+    "\n    for (i = 0; i < count; i++)"
+    "\n        fprintf(stderr, \"[profile] %-32s %12ld %14.3f %14.3f  %s:%d\\n\","
+    "\n                sites[i]->name, sites[i]->calls, sites[i]->inclusive / 1e6,"
+    "\n                sites[i]->exclusive / 1e6, sites[i]->file, sites[i]->line);"
+    "\n"
+    "\n    free(sites);"
+    "\n}\n";
+
+const static std::string PROFILE_ENTER =
+    "\nProfileSite*"
+    "\nprofileEnter(ProfileSite* site)"
+    "\n{"
+    "\n    ProfileFrame* frame;"
+    "\n"
+    "\n    if (site->calls == 0)"
+    "\n    {"
+    "\n        if (profileSites == NULL)"
+    "\n            atexit(reportProfile);"
+    "\n        site->next = profileSites;"
+    "\n        profileSites = site;"
+    "\n    }"
+    "\n"
+    "\n    if (profileDepth == profileCapacity)"
+    "\n    {"
+    "\n        profileCapacity = profileCapacity ? profileCapacity * 2 : 1024;"
+    "\n        profileStack ="
+    "\n            realloc(profileStack, profileCapacity * sizeof(ProfileFrame));"
+    "\n    }"
+    "\n"
+    "\n    site->calls++;"
+    "\n    site->active++;"
+    "\n    frame = &profileStack[profileDepth++];"
+    "\n    frame->site = site;"
+    "\n    frame->children = 0;"
+    "\n    frame->start = profileNow();"
+    "\n    return site;"
+    "\n}\n";
+
+const static std::string PROFILE_EXIT =
+    "\nvoid"
+    "\nprofileExit(ProfileSite** site)"
+    "\n{"
+    "\n    unsigned long long now = profileNow();"
+    "\n    ProfileFrame* frame = &profileStack[--profileDepth];"
+    "\n    unsigned long long elapsed = now - frame->start;"
+    "\n"
+    "\n    (*site)->exclusive += elapsed - frame->children;"
+    "\n    if (--(*site)->active == 0)"
+    "\n        (*site)->inclusive += elapsed;"
+    "\n"
+    "\n    if (profileDepth > 0)"
+    "\n        profileStack[profileDepth - 1].children += elapsed;"
+    "\n}\n";
+
+std::string getProfileStdLibC();
+std::string getProfileStdLibCDeclarations();
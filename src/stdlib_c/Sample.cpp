@@ -0,0 +1,17 @@
+/*
+ * Robert Durst 2019
+ * Sailfish Programming Language
+ */
+#include "Sample.h"
+std::string
+getSampleStdLibC()
+{
+    return SAMPLE_STATE + SAMPLE_CHILD + SAMPLE_SIGNAL + WRITE_SAMPLES +
+           START_SAMPLING + SAMPLE_ENTER + SAMPLE_EXIT;
+}
+
+std::string
+getSampleStdLibCDeclarations()
+{
+    return SAMPLE_DECLARATIONS;
+}
@@ -0,0 +1,188 @@
+/*
+ * Robert Durst 2019
+ * Sailfish Programming Language
+ */
+#pragma once
+#include <string>
+
+// A sampling profiler for programs compiled with --sample, which keeps a
+// stack of the Sailfish functions being run.
+const static std::string SAMPLE_DECLARATIONS =
+    "\n#include <signal.h>"
+    "\n#include <sys/time.h>"
+    "\nvoid startSampling(const char* path);"
+    "\nint sampleEnter(const char* name);"
+    "\nvoid sampleExit(int* call);\n";
+
+const static std::string SAMPLE_STATE =
+    "\n/* Functions compiled with --sample push their name on sampleStack when"
+    "\n   called and pop it, through a cleanup attribute, when they return. Every"
+    "\n   millisecond of CPU time SIGPROF adds the stack as it stands to a tree of"
+    "\n   the stacks seen so far, whose nodes are allocated up front since the"
+    "\n   handler can not call malloc. At exit the tree is written out as folded"
+    "\n   stacks, one \"outer;...;inner count\" line per stack, which flame graph"
+    "\n   tools read. Stacks deeper than SAMPLE_DEPTH keep their innermost frames"
+    "\n   under a [truncated] root. */"
+    "\n#define SAMPLE_STACK (1 << 20)"
+    "\n#define SAMPLE_DEPTH 1024"
+    "\n#define SAMPLE_NODES (1 << 18)"
+    "\n#define SAMPLE_INTERVAL 1000"
+    "\n"
+    "\ntypedef struct SampleNode"
+    "\n{"
+    "\n    const char* name;"
+    "\n    int child;"
+    "\n    int sibling;"
+    "\n    long count;"
+    "\n} SampleNode;"
+    "\n"
+    "\nstatic const char* volatile sampleStack[SAMPLE_STACK];"
+    "\nstatic volatile size_t sampleDepth = 0;"
+    "\nstatic SampleNode* sampleNodes = NULL;"
+    "\nstatic int sampleNodeCount = 0;"
+    "\nstatic long sampleDropped = 0;"
+    "\nstatic const char* samplePath = NULL;\n";
+
+const static std::string SAMPLE_CHILD =
+    "\nstatic int"
+    "\nsampleChild(int parent, const char* name)"
+    "\n{"
+    "\n    int node;"
+    "\n"
+    "\n    for (node = sampleNodes[parent].child; node != 0;"
+    "\n         node = sampleNodes[node].sibling)"
+    "\n        if (sampleNodes[node].name == name)"
+    "\n            return node;"
+    "\n"
+    "\n    if (sampleNodeCount == SAMPLE_NODES)"
+    "\n        return -1;"
+    "\n"
+    "\n    node = sampleNodeCount++;"
+    "\n    sampleNodes[node].name = name;"
+    "\n    sampleNodes[node].child = 0;"
+    "\n    sampleNodes[node].sibling = sampleNodes[parent].child;"
+    "\n    sampleNodes[node].count = 0;"
+    "\n    sampleNodes[parent].child = node;"
+    "\n    return node;"
+    "\n}\n";
+
+const static std::string SAMPLE_SIGNAL =
+    "\nstatic void"
+    "\nsampleSignal(int signal)"
+    "\n{"
+    "\n    size_t depth = sampleDepth;"
+    "\n    size_t i = 0;"
+    "\n    int node = 0;"
+    "\n"
+    "\n    (void)signal;"
+    "\n    if (depth > SAMPLE_STACK)"
+    "\n        depth = SAMPLE_STACK;"
+    "\n    if (depth > SAMPLE_DEPTH)"
+    "\n    {"
+    "\n        i = depth - SAMPLE_DEPTH;"
+    "\n        node = sampleChild(node, \"[truncated]\");"
+    "\n    }"
+    "\n"
+    "\n    for (; i < depth && node >= 0; i++)"
+    "\n        node = sampleChild(node, sampleStack[i]);"
+    "\n"
+    "\n    if (node > 0)"
+    "\n        sampleNodes[node].count++;"
+    "\n    else"
+    "\n        sampleDropped++;"
+    "\n}\n";
+
+const static std::string WRITE_SAMPLES =
+    "\nstatic void"
+    "\nwriteSampleNode(FILE* out, int node, char* path, size_t length)"
+    "\n{"
+    "\n    size_t size = strlen(sampleNodes[node].name);"
+    "\n    int child;"
+    "\n"
+    "\n    if (length > 0)"
+    "\n        path[length++] = ';';"
+    "\n    memcpy(path + length, sampleNodes[node].name, size);"
+    "\n    length += size;"
+    "\n"
+    "\n    if (sampleNodes[node].count > 0)"
+    "\n        fprintf(out, \"%.*s %ld\\n\", (int)length, path, sampleNodes[node].count);"
+    "\n"
+    "\n    for (child = sampleNodes[node].child; child != 0;"
+    "\n         child = sampleNodes[child].sibling)"
+    "\n        writeSampleNode(out, child, path, length);"
+    "\n}"
+    "\n"
+    "\nstatic void"
+    "\nwriteSamples()"
+    "\n{"
+    "\n    struct itimerval off = {{0, 0}, {0, 0}};"
+    "\n    size_t longest = strlen(\"[truncated]\");"
+    "\n    char* path;"
+    "\n    FILE* out;"
+    "\n    int node;"
+    "\n"
+    "\n    setitimer(ITIMER_PROF, &off, NULL);"
+    "\n    signal(SIGPROF, SIG_IGN);"
+    "\n"
+    "\n    out = fopen(samplePath, \"w\");"
+    "\n    if (out == NULL)"
+    "\n    {"
+    "\n        fprintf(stderr, \"[sample] unable to write %s\\n\", samplePath);"
+    "\n        return;"
+    "\n    }"
+    "\n"
+    "\n    for (node = 1; node < sampleNodeCount; node++)"
+    "\n        if (strlen(sampleNodes[node].name) > longest)"
+    "\n            longest = strlen(sampleNodes[node].name);"
+    "\n"
+    "\n    path = malloc((SAMPLE_DEPTH + 1) * (longest + 1));"
+    "\n    for (node = sampleNodes[0].child; node != 0;"
+    "\n         node = sampleNodes[node].sibling)"
+    "\n        writeSampleNode(out, node, path, 0);"
+    "\n    if (sampleDropped > 0)"
+    "\n        fprintf(out, \"[dropped] %ld\\n\", sampleDropped);"
+    "\n"
+    "\n    free(path);"
+    "\n    fclose(out);"
+    "\n}\n";
+
+const static std::string START_SAMPLING =
+    "\nvoid"
+    "\nstartSampling(const char* path)"
+    "\n{"
+    "\n    struct sigaction action;"
+    "\n    struct itimerval interval = {{0, SAMPLE_INTERVAL}, {0, SAMPLE_INTERVAL}};"
+    "\n"
+    "\n    samplePath = path;"
+    "\n    sampleNodes = calloc(SAMPLE_NODES, sizeof(SampleNode));"
+    "\n    sampleNodeCount = 1;"
+    "\n    atexit(writeSamples);"
+    "\n"
+    "\n    memset(&action, 0, sizeof(action));"
+    "\n    action.sa_handler = sampleSignal;"
+    "\n    action.sa_flags = SA_RESTART;"
+    "\n    sigemptyset(&action.sa_mask);"
+    "\n    sigaction(SIGPROF, &action, NULL);"
+    "\n    setitimer(ITIMER_PROF, &interval, NULL);"
+    "\n}\n";
+
+const static std::string SAMPLE_ENTER =
+    "\nint"
+    "\nsampleEnter(const char* name)"
+    "\n{"
+    "\n    if (sampleDepth < SAMPLE_STACK)"
+    "\n        sampleStack[sampleDepth] = name;"
+    "\n    sampleDepth++;"
+    "\n    return 0;"
+    "\n}\n";
+
+const static std::string SAMPLE_EXIT =
+    "\nvoid"
+    "\nsampleExit(int* call)"
+    "\n{"
+    "\n    (void)call;"
+    "\n    sampleDepth--;"
+    "\n}\n";
+
+std::string getSampleStdLibC();
+std::string getSampleStdLibCDeclarations();
@@ -0,0 +1,16 @@
+/*
+ * Robert Durst 2019
+ * Sailfish Programming Language
+ */
+#include "Sort.h"
+std::string
+getSortStdLibC()
+{
+    return SORT_LIST_INT + SORT_LIST_FLT + SORT_LIST_STR;
+}
+
+std::string
+getSortStdLibCDeclarations()
+{
+    return SORT_DECLARATIONS;
+}
@@ -0,0 +1,343 @@
+/*
+ * Robert Durst 2019
+ * Sailfish Programming Language
+ */
+#pragma once
+#include <string>
+
+// In place sorts for lists: LSD radix sort for [int], introsort for [flt]
+// and [str]. Strings are ordered by strcmp.
+const static std::string SORT_DECLARATIONS =
+    "\nint* sortListInt(int* a);"
+    "\nfloat* sortListFlt(float* a);"
+    "\nchar** sortListStr(char** a);\n";
+
+const static std::string SORT_LIST_INT =
+    "\n/* LSD radix sort, one byte per pass. Flipping the sign bit makes the"
+    "\n   unsigned byte order match signed int order. Passes where every key has"
+    "\n   the same byte are skipped. */"
+    "\nint*"
+    "\nsortListInt(int* a)"
+    "\n{"
+    "\n    int n = len(a);"
+    "\n    unsigned int* keys = (unsigned int*)a;"
+    "\n    unsigned int* from;"
+    "\n    unsigned int* to;"
+    "\n    unsigned int* swap;"
+    "\n    unsigned int* scratch;"
+    "\n    int counts[256];"
+    "\n    int shift;"
+    "\n    int i;"
+    "\n"
+    "\n    if (n < 2)"
+    "\n        return a;"
+    "\n"
+    "\n    scratch = (unsigned int*)malloc(n * sizeof(unsigned int));"
+    "\n    for (i = 0; i < n; i++)"
+    "\n        keys[i] ^= 0x80000000u;"
+    "\n"
+    "\n    from = keys;"
+    "\n    to = scratch;"
+    "\n    for (shift = 0; shift < 32; shift += 8)"
+    "\n    {"
+    "\n        int total = 0;"
+    "\n        memset(counts, 0, sizeof(counts));"
+    "\n        for (i = 0; i < n; i++)"
+    "\n            counts[(from[i] >> shift) & 0xff]++;"
+    "\n        if (counts[(from[0] >> shift) & 0xff] == n)"
+    "\n            continue;"
+    "\n"
+    "\n        for (i = 0; i < 256; i++)"
+    "\n        {"
+    "\n            int count = counts[i];"
+    "\n            counts[i] = total;"
+    "\n            total += count;"
+    "\n        }"
+    "\n        for (i = 0; i < n; i++)"
+    "\n            to[counts[(from[i] >> shift) & 0xff]++] = from[i];"
+    "\n"
+    "\n        swap = from;"
+    "\n        from = to;"
+    "\n        to = swap;"
+    "\n    }"
+    "\n"
+    "\n    if (from != keys)"
+    "\n        memcpy(keys, from, n * sizeof(unsigned int));"
+    "\n    for (i = 0; i < n; i++)"
+    "\n        keys[i] ^= 0x80000000u;"
+    "\n    free(scratch);"
+    "\n    return a;"
+    "\n}\n";
+
+const static std::string SORT_LIST_FLT =
+    "\nstatic void"
+    "\nsiftFlt(float* a, int root, int n)"
+    "\n{"
+    "\n    while (2 * root + 1 < n)"
+    "\n    {"
+    "\n        int child = 2 * root + 1;"
+    "\n        float tmp;"
+    "\n        if (child + 1 < n && a[child] < a[child + 1])"
+    "\n            child++;"
+    "\n        if (!(a[root] < a[child]))"
+    "\n            return;"
+    "\n        tmp = a[root];"
+    "\n        a[root] = a[child];"
+    "\n        a[child] = tmp;"
+    "\n        root = child;"
+    "\n    }"
+    "\n}"
+    "\n"
+    "\nstatic void"
+    "\nheapSortFlt(float* a, int n)"
+    "\n{"
+    "\n    int i;"
+    "\n    for (i = n / 2 - 1; i >= 0; i--)"
+    "\n        siftFlt(a, i, n);"
+    "\n    for (i = n - 1; i > 0; i--)"
+    "\n    {"
+    "\n        float tmp = a[0];"
+    "\n        a[0] = a[i];"
+    "\n        a[i] = tmp;"
+    "\n        siftFlt(a, 0, i);"
+    "\n    }"
+    "\n}"
+    "\n"
+    "\nstatic void"
+    "\ninsertionSortFlt(float* a, int n)"
+    "\n{"
+    "\n    int i;"
+    "\n    for (i = 1; i < n; i++)"
+    "\n    {"
+    "\n        float value = a[i];"
+    "\n        int j = i - 1;"
+    "\n        while (j >= 0 && value < a[j])"
+    "\n        {"
+    "\n            a[j + 1] = a[j];"
+    "\n            j--;"
+    "\n        }"
+    "\n        a[j + 1] = value;"
+    "\n    }"
+    "\n}"
+    "\n"
+    "\n/* quicksort on a median of three pivot, finishing small ranges with"
+    "\n   insertion sort and falling back to heapsort when the recursion gets too"
+    "\n   deep, so the worst case stays O(n log n) */"
+    "\nstatic void"
+    "\nintroSortFlt(float* a, int n, int depth)"
+    "\n{"
+    "\n    while (n > 16)"
+    "\n    {"
+    "\n        float pivot;"
+    "\n        float tmp;"
+    "\n        int i = 0;"
+    "\n        int j = n - 1;"
+    "\n        int mid = n / 2;"
+    "\n"
+    "\n        if (depth-- == 0)"
+    "\n        {"
+    "\n            heapSortFlt(a, n);"
+    "\n            return;"
+    "\n        }"
+    "\n"
+    "\n        if (a[mid] < a[0])"
+    "\n        {"
+    "\n            tmp = a[mid];"
+    "\n            a[mid] = a[0];"
+    "\n            a[0] = tmp;"
+    "\n        }"
+    "\n        if (a[n - 1] < a[0])"
+    "\n        {"
+    "\n            tmp = a[n - 1];"
+    "\n            a[n - 1] = a[0];"
+    "\n            a[0] = tmp;"
+    "\n        }"
+    "\n        if (a[n - 1] < a[mid])"
+    "\n        {"
+    "\n            tmp = a[n - 1];"
+    "\n            a[n - 1] = a[mid];"
+    "\n            a[mid] = tmp;"
+    "\n        }"
+    "\n        pivot = a[mid];"
+    "\n"
+    "\n        while (i <= j)"
+    "\n        {"
+    "\n            while (a[i] < pivot)"
+    "\n                i++;"
+    "\n            while (pivot < a[j])"
+    "\n                j--;"
+    "\n            if (i <= j)"
+    "\n            {"
+    "\n                tmp = a[i];"
+    "\n                a[i] = a[j];"
+    "\n                a[j] = tmp;"
+    "\n                i++;"
+    "\n                j--;"
+    "\n            }"
+    "\n        }"
+    "\n"
+    "\n        /* recurse into the smaller side, loop on the larger one */"
+    "\n        if (j + 1 < n - i)"
+    "\n        {"
+    "\n            introSortFlt(a, j + 1, depth);"
+    "\n            a += i;"
+    "\n            n -= i;"
+    "\n        }"
+    "\n        else"
+    "\n        {"
+    "\n            introSortFlt(a + i, n - i, depth);"
+    "\n            n = j + 1;"
+    "\n        }"
+    "\n    }"
+    "\n    insertionSortFlt(a, n);"
+    "\n}"
+    "\n"
+    "\nfloat*"
+    "\nsortListFlt(float* a)"
+    "\n{"
+    "\n    int n = len(a);"
+    "\n    int depth = 0;"
+    "\n    int m;"
+    "\n    for (m = n; m > 1; m >>= 1)"
+    "\n        depth += 2;"
+    "\n    introSortFlt(a, n, depth);"
+    "\n    return a;"
+    "\n}\n";
+
+const static std::string SORT_LIST_STR =
+    "\nstatic void"
+    "\nsiftStr(char** a, int root, int n)"
+    "\n{"
+    "\n    while (2 * root + 1 < n)"
+    "\n    {"
+    "\n        int child = 2 * root + 1;"
+    "\n        char* tmp;"
+    "\n        if (child + 1 < n && strcmp(a[child], a[child + 1]) < 0)"
+    "\n            child++;"
+    "\n        if (!(strcmp(a[root], a[child]) < 0))"
+    "\n            return;"
+    "\n        tmp = a[root];"
+    "\n        a[root] = a[child];"
+    "\n        a[child] = tmp;"
+    "\n        root = child;"
+    "\n    }"
+    "\n}"
+    "\n"
+    "\nstatic void"
+    "\nheapSortStr(char** a, int n)"
+    "\n{"
+    "\n    int i;"
+    "\n    for (i = n / 2 - 1; i >= 0; i--)"
+    "\n        siftStr(a, i, n);"
+    "\n    for (i = n - 1; i > 0; i--)"
+    "\n    {"
+    "\n        char* tmp = a[0];"
+    "\n        a[0] = a[i];"
+    "\n        a[i] = tmp;"
+    "\n        siftStr(a, 0, i);"
+    "\n    }"
+    "\n}"
+    "\n"
+    "\nstatic void"
+    "\ninsertionSortStr(char** a, int n)"
+    "\n{"
+    "\n    int i;"
+    "\n    for (i = 1; i < n; i++)"
+    "\n    {"
+    "\n        char* value = a[i];"
+    "\n        int j = i - 1;"
+    "\n        while (j >= 0 && strcmp(value, a[j]) < 0)"
+    "\n        {"
+    "\n            a[j + 1] = a[j];"
+    "\n            j--;"
+    "\n        }"
+    "\n        a[j + 1] = value;"
+    "\n    }"
+    "\n}"
+    "\n"
+    "\n/* quicksort on a median of three pivot, finishing small ranges with"
+    "\n   insertion sort and falling back to heapsort when the recursion gets too"
+    "\n   deep, so the worst case stays O(n log n) */"
+    "\nstatic void"
+    "\nintroSortStr(char** a, int n, int depth)"
+    "\n{"
+    "\n    while (n > 16)"
+    "\n    {"
+    "\n        char* pivot;"
+    "\n        char* tmp;"
+    "\n        int i = 0;"
+    "\n        int j = n - 1;"
+    "\n        int mid = n / 2;"
+    "\n"
+    "\n        if (depth-- == 0)"
+    "\n        {"
+    "\n            heapSortStr(a, n);"
+    "\n            return;"
+    "\n        }"
+    "\n"
+    "\n        if (strcmp(a[mid], a[0]) < 0)"
+    "\n        {"
+    "\n            tmp = a[mid];"
+    "\n            a[mid] = a[0];"
+    "\n            a[0] = tmp;"
+    "\n        }"
+    "\n        if (strcmp(a[n - 1], a[0]) < 0)"
+    "\n        {"
+    "\n            tmp = a[n - 1];"
+    "\n            a[n - 1] = a[0];"
+    "\n            a[0] = tmp;"
+    "\n        }"
+    "\n        if (strcmp(a[n - 1], a[mid]) < 0)"
+    "\n        {"
+    "\n            tmp = a[n - 1];"
+    "\n            a[n - 1] = a[mid];"
+    "\n            a[mid] = tmp;"
+    "\n        }"
+    "\n        pivot = a[mid];"
+    "\n"
+    "\n        while (i <= j)"
+    "\n        {"
+    "\n            while (strcmp(a[i], pivot) < 0)"
+    "\n                i++;"
+    "\n            while (strcmp(pivot, a[j]) < 0)"
+    "\n                j--;"
+    "\n            if (i <= j)"
+    "\n            {"
+    "\n                tmp = a[i];"
+    "\n                a[i] = a[j];"
+    "\n                a[j] = tmp;"
+    "\n                i++;"
+    "\n                j--;"
+    "\n            }"
+    "\n        }"
+    "\n"
+    "\n        /* recurse into the smaller side, loop on the larger one */"
+    "\n        if (j + 1 < n - i)"
+    "\n        {"
+    "\n            introSortStr(a, j + 1, depth);"
+    "\n            a += i;"
+    "\n            n -= i;"
+    "\n        }"
+    "\n        else"
+    "\n        {"
+    "\n            introSortStr(a + i, n - i, depth);"
+    "\n            n = j + 1;"
+    "\n        }"
+    "\n    }"
+    "\n    insertionSortStr(a, n);"
+    "\n}"
+    "\n"
+    "\nchar**"
+    "\nsortListStr(char** a)"
+    "\n{"
+    "\n    int n = len(a);"
+    "\n    int depth = 0;"
+    "\n    int m;"
+    "\n    for (m = n; m > 1; m >>= 1)"
+    "\n        depth += 2;"
+    "\n    introSortStr(a, n, depth);"
+    "\n    return a;"
+    "\n}\n";
+
+std::string getSortStdLibC();
+std::string getSortStdLibCDeclarations();
@@ -5,7 +5,57 @@
 #include "stdlib_c.h"
 
 std::string
-getStdLibC()
+getStdLibC(const std::string& program, const CompilerOptions& options)
 {
-    return stdlib_c_HEADER + getListsStdLibC() + stdlib_c_FOOTER;
-}
\ No newline at end of file
+    // the profiling runtimes only come with the option that uses them
+    std::string declarations, definitions;
+    if (options.instrument)
+    {
+        declarations += getProfileStdLibCDeclarations();
+        definitions += getProfileStdLibC();
+    }
+    if (options.sampleFile != "")
+    {
+        declarations += getSampleStdLibCDeclarations();
+        definitions += getSampleStdLibC();
+    }
+    if (options.profileGenerateFile != "")
+    {
+        declarations += getBranchCountsStdLibCDeclarations();
+        definitions += getBranchCountsStdLibC();
+    }
+
+    return stdlib_c_HEADER + getAllocStdLibCDeclarations() +
+           getListsStdLibCDeclarations() + getKernelsStdLibCDeclarations() +
+           getSortStdLibCDeclarations() + getMathStdLibCDeclarations() +
+           getOutputStdLibCDeclarations() + declarations + getAllocStdLibC() +
+           getListsStdLibC() + getKernelsStdLibC(program) + getSortStdLibC() +
+           getMathStdLibC() + getOutputStdLibC() + definitions +
+           stdlib_c_FOOTER;
+}
+
+std::string
+getStdLibCHeaderFile()
+{
+    return "/* Generated by sailfishc --emit_runtime. Do not alter! */"
+           "\n#ifndef SAILFISH_RUNTIME_H"
+           "\n#define SAILFISH_RUNTIME_H\n" +
+           stdlib_c_INCLUDES + getAllocStdLibCDeclarations() +
+           getListsStdLibCDeclarations() + getKernelsStdLibCDeclarations() +
+           getSortStdLibCDeclarations() + getMathStdLibCDeclarations() +
+           getOutputStdLibCDeclarations() + getProfileStdLibCDeclarations() +
+           getSampleStdLibCDeclarations() +
+           getBranchCountsStdLibCDeclarations() + "\n#endif\n";
+}
+
+std::string
+getStdLibCSourceFile()
+{
+    return "/* Generated by sailfishc --emit_runtime. Do not alter! */"
+           "\n#include \"" +
+           stdlib_c_RUNTIME_NAME + ".h\"\n" + stdlib_c_HEADER +
+           getAllocStdLibC() + getListsStdLibC() + getKernelsStdLibC() +
+           getSortStdLibC() + getMathStdLibC() + getOutputStdLibC() +
+           getProfileStdLibC() + getSampleStdLibC() + getBranchCountsStdLibC() +
+           stdlib_c_FOOTER;
+}
@@ -3,7 +3,16 @@
  * Sailfish Programming Language
  */
 #pragma once
+#include "../common/CompilerOptions.h"
+#include "Alloc.h"
+#include "BranchCounts.h"
+#include "Kernels.h"
 #include "Lists.h"
+#include "Math.h"
+#include "Output.h"
+#include "Profile.h"
+#include "Sample.h"
+#include "Sort.h"
 #include <string>
 
 const static std::string stdlib_c_HEADER =
@@ -12,4 +21,21 @@ const static std::string stdlib_c_HEADER =
 const static std::string stdlib_c_FOOTER =
     "\n//___________END_STDLIB__________/_//\n\n";
 
-std::string getStdLibC();
\ No newline at end of file
+// name of the header generated code includes when linking against the
+// precompiled runtime instead of carrying its own copy of the stdlib
+const static std::string stdlib_c_RUNTIME_NAME = "sailfish";
+
+const static std::string stdlib_c_INCLUDES = "\n#include <stdio.h>"
+                                             "\n#include <stdlib.h>"
+                                             "\n#include <string.h>"
+                                             "\n";
+
+// the stdlib as C source, for programs compiled as a single file; of the
+// list kernels only those the program's C calls are included, and the
+// profiling runtimes only when the options compile calls to them
+std::string getStdLibC(const std::string& program,
+                       const CompilerOptions& options);
+
+// contents of sailfish.h and sailfish.c, the precompiled runtime library
+std::string getStdLibCHeaderFile();
+std::string getStdLibCSourceFile();
\ No newline at end of file
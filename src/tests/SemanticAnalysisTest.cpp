@@ -17,8 +17,6 @@ SEMANTIC_ANALYSIS_TEST(const std::string& filename)
             "Mismatched types. Expected/LeftHand is: int.",
             "Mismatched types. Expected/LeftHand is: int or flt.",
             "Mismatched types. Expected/LeftHand is: int.",
-            "Mismatched types. Expected/LeftHand is: int.",
-            "Mismatched types. Expected/LeftHand is: int.",
             "Mismatched types. Expected/LeftHand is: int or flt.",
             "Mismatched types. Expected/LeftHand is: int or flt.",
             "Mismatched types. Expected/LeftHand is: bool.",
@@ -0,0 +1,527 @@
+/*
+ * Robert Durst 2019
+ * Sailfish Programming Language
+ */
+#include "ConstantFolder.h"
+#include <climits>
+#include <cmath>
+#include <cstdlib>
+#include <iomanip>
+#include <sstream>
+
+// binary operators from lowest to highest precedence, as in C
+const static std::vector<std::vector<std::string>> BINARY_OPERATORS = {
+    {"||"}, {"&&"}, {"==", "!="}, {"<", "<=", ">", ">="},
+    {"+", "-"}, {"*", "/", "%"}};
+
+const static std::vector<std::string> ASSIGNMENT_OPERATORS = {"=", "+=", "-=",
+                                                             "*=", "/="};
+
+const static std::vector<std::string> C_TYPES = {"int", "float", "char",
+                                                 "void", "struct"};
+
+bool
+isOneOf(const std::string& s, const std::vector<std::string>& options)
+{
+    for (auto const& option : options)
+        if (s == option)
+            return true;
+    return false;
+}
+
+ConstantFolder::ConstantFolder(
+    const std::function<std::string(const std::string&)>& lookup)
+{
+    this->lookup = lookup;
+    current = 0;
+    failed = false;
+}
+
+std::string
+ConstantFolder::formatInt(int32_t i)
+{
+    // negative literals are bracketed so that they survive being placed
+    // after another operator
+    return i < 0 ? "(" + std::to_string(i) + ")" : std::to_string(i);
+}
+
+std::string
+ConstantFolder::formatFlt(double f, bool isSingle)
+{
+    // the shortest literal which reads back as the same value
+    std::string s = "";
+    for (int precision = 1; precision <= 17; precision++)
+    {
+        std::ostringstream out;
+        out << std::setprecision(precision) << f;
+        s = out.str();
+        if ((isSingle && strtof(s.c_str(), NULL) == (float)f) ||
+            (!isSingle && strtod(s.c_str(), NULL) == f))
+            break;
+    }
+
+    if (s.find_first_of(".e") == std::string::npos)
+        s += ".0";
+    if (isSingle)
+        s += "f";
+    return std::signbit(f) ? "(" + s + ")" : s;
+}
+
+std::string
+ConstantFolder::toSingle(const std::string& literal)
+{
+    auto digits = literal[0] == '(' ? literal.substr(1, literal.size() - 2)
+                                    : literal;
+    return formatFlt(strtof(digits.c_str(), NULL), true);
+}
+
+bool
+ConstantFolder::tokenize(const std::string& s)
+{
+    const std::string twoCharOperators[] = {"->", "++", "--", "+=", "-=",
+                                            "*=", "/=", "==", "!=", "<=",
+                                            ">=", "&&", "||"};
+
+    size_t i = 0;
+    while (i < s.size())
+    {
+        auto c = s[i];
+        auto end = i + 1;
+        if (c == ' ' || c == '\n')
+        {
+            ++i;
+            continue;
+        }
+        else if (c == '"')
+        {
+            while (end < s.size() && s[end] != '"')
+                end += (s[end] == '\\') ? 2 : 1;
+            if (end >= s.size())
+                return false;
+            ++end;
+        }
+        else if (isdigit(c) || (c == '.' && isdigit(s[end])))
+        {
+            while (end < s.size() &&
+                   (isalnum(s[end]) || s[end] == '.' ||
+                    ((s[end] == '+' || s[end] == '-') &&
+                     (s[end - 1] == 'e' || s[end - 1] == 'E'))))
+                ++end;
+        }
+        else if (isalpha(c) || c == '_')
+        {
+            while (end < s.size() && (isalnum(s[end]) || s[end] == '_'))
+                ++end;
+        }
+        else if (std::string("+-*/%<>=!&|(),.[]").find(c) !=
+                 std::string::npos)
+        {
+            for (auto const& op : twoCharOperators)
+                if (s.compare(i, 2, op) == 0)
+                    end = i + 2;
+        }
+        else
+            return false;
+
+        tokens.push_back(s.substr(i, end - i));
+        i = end;
+    }
+
+    return true;
+}
+
+std::string
+ConstantFolder::peek()
+{
+    return current < tokens.size() ? tokens[current] : "";
+}
+
+std::string
+ConstantFolder::next()
+{
+    auto token = peek();
+    if (token == "")
+        failed = true;
+    else
+        ++current;
+    return token;
+}
+
+void
+ConstantFolder::expect(const std::string& token)
+{
+    if (next() != token)
+        failed = true;
+}
+
+// the value of a numeric literal, if C would give it the same value
+ConstantFolder::Value
+ConstantFolder::literal(const std::string& token)
+{
+    Value v;
+    v.text = token;
+    v.source = token;
+
+    if (token.find_first_of(".eE") != std::string::npos)
+    {
+        v.isSingle = token.back() == 'f';
+        auto digits = v.isSingle ? token.substr(0, token.size() - 1) : token;
+        if (digits.find_first_not_of("0123456789.eE+-") != std::string::npos)
+            return v;
+
+        v.f = v.isSingle ? strtof(digits.c_str(), NULL)
+                         : strtod(digits.c_str(), NULL);
+        v.isFlt = true;
+        v.isConstant = std::isfinite(v.f);
+    }
+    // leading zeros would be octal, and larger values are not ints
+    else if (token.find_first_not_of("0123456789") == std::string::npos &&
+             (token == "0" || token[0] != '0') && token.size() <= 10 &&
+             std::stoll(token) <= INT_MAX)
+    {
+        v.i = std::stoi(token);
+        v.isConstant = true;
+    }
+
+    return v;
+}
+
+// makes v a constant, unless its value is one C would not write as a literal
+ConstantFolder::Value
+ConstantFolder::constant(Value v)
+{
+    if (v.isFlt && !std::isfinite(v.f))
+        return v;
+
+    v.isConstant = true;
+    v.text = v.isFlt ? formatFlt(v.f, v.isSingle) : formatInt(v.i);
+    v.folds = 1;
+    return v;
+}
+
+template <typename T>
+bool
+compare(const std::string& op, T l, T r)
+{
+    if (op == "==")
+        return l == r;
+    if (op == "!=")
+        return l != r;
+    if (op == "<")
+        return l < r;
+    if (op == "<=")
+        return l <= r;
+    if (op == ">")
+        return l > r;
+    return l >= r;
+}
+
+template <typename T>
+T
+arithmetic(const std::string& op, T l, T r)
+{
+    if (op == "+")
+        return l + r;
+    if (op == "-")
+        return l - r;
+    if (op == "*")
+        return l * r;
+    return l / r;
+}
+
+ConstantFolder::Value
+ConstantFolder::foldBinary(const std::string& op, const Value& left,
+                           const Value& right)
+{
+    Value v;
+    v.text = left.text + " " + op + " " + right.text;
+    v.source = left.source + " " + op + " " + right.source;
+    v.folds = left.folds + right.folds;
+
+    auto isLogical = op == "&&" || op == "||";
+    auto isComparison = isOneOf(op, BINARY_OPERATORS[2]) ||
+                        isOneOf(op, BINARY_OPERATORS[3]);
+    auto isTrue = [](const Value& x) { return x.isFlt ? x.f != 0 : x.i != 0; };
+
+    // C skips the right of && and || when the left decides them
+    if (isLogical && left.isConstant && isTrue(left) == (op == "||"))
+    {
+        v.i = op == "||";
+        return constant(v);
+    }
+
+    if (!left.isConstant || !right.isConstant)
+        return v;
+
+    if (isLogical)
+    {
+        v.i = isTrue(right);
+        return constant(v);
+    }
+
+    if (left.isFlt || right.isFlt)
+    {
+        // float with float or int stays float, anything with a double is
+        // a double
+        auto isSingle = (left.isSingle || !left.isFlt) &&
+                        (right.isSingle || !right.isFlt);
+        double l = left.isFlt ? left.f : left.i;
+        double r = right.isFlt ? right.f : right.i;
+
+        if (isComparison)
+            v.i = isSingle ? compare<float>(op, l, r) : compare(op, l, r);
+        else if (op == "%")
+            return v;
+        else
+        {
+            v.isFlt = true;
+            v.isSingle = isSingle;
+            v.f = isSingle ? arithmetic<float>(op, l, r) : arithmetic(op, l, r);
+        }
+        return constant(v);
+    }
+
+    int64_t l = left.i;
+    int64_t r = right.i;
+    if ((op == "/" || op == "%") && (r == 0 || (l == INT_MIN && r == -1)))
+        return v;
+
+    // ints wrap on overflow
+    auto result = isComparison ? compare(op, l, r)
+                               : op == "%" ? l % r : arithmetic(op, l, r);
+    v.i = (int32_t)(uint32_t)(uint64_t)result;
+    return constant(v);
+}
+
+ConstantFolder::Value
+ConstantFolder::foldUnary(const std::string& op, const Value& operand)
+{
+    Value v;
+    v.text = op + operand.text;
+    v.source = op + operand.source;
+    v.folds = operand.folds;
+
+    if (!operand.isConstant || (op == "-" && !operand.isFlt &&
+                                operand.i == INT_MIN))
+        return v;
+
+    if (op == "!")
+        v.i = operand.isFlt ? operand.f == 0 : operand.i == 0;
+    else
+    {
+        v.isFlt = operand.isFlt;
+        v.isSingle = operand.isSingle;
+        v.f = op == "-" ? -operand.f : operand.f;
+        v.i = op == "-" ? -operand.i : operand.i;
+    }
+
+    return constant(v);
+}
+
+ConstantFolder::Value
+ConstantFolder::parseAssignment()
+{
+    auto left = parseBinary(0);
+    if (!isOneOf(peek(), ASSIGNMENT_OPERATORS))
+        return left;
+
+    // the target keeps its name even if it held a constant until now
+    auto op = next();
+    auto right = parseAssignment();
+
+    Value v;
+    v.text = left.source + " " + op + " " + right.text;
+    v.source = left.source + " " + op + " " + right.source;
+    v.folds = right.folds;
+    return v;
+}
+
+ConstantFolder::Value
+ConstantFolder::parseBinary(int level)
+{
+    if (level == (int)BINARY_OPERATORS.size())
+        return parseUnary();
+
+    auto left = parseBinary(level + 1);
+    while (!failed && isOneOf(peek(), BINARY_OPERATORS[level]))
+    {
+        auto op = next();
+        auto right = parseBinary(level + 1);
+        left = foldBinary(op, left, right);
+    }
+
+    return left;
+}
+
+ConstantFolder::Value
+ConstantFolder::parseUnary()
+{
+    auto op = peek();
+    if (op == "!" || op == "-" || op == "+")
+    {
+        next();
+        return foldUnary(op, parseUnary());
+    }
+
+    if (op == "++" || op == "--")
+    {
+        next();
+        auto operand = parseUnary();
+        Value v;
+        v.text = op + operand.source;
+        v.source = v.text;
+        return v;
+    }
+
+    return parsePostfix();
+}
+
+ConstantFolder::Value
+ConstantFolder::parsePostfix()
+{
+    auto v = parsePrimary();
+    while (!failed)
+    {
+        auto op = peek();
+        if (op == "(")
+        {
+            // a call: the callee is a name, never a constant
+            next();
+            v.text = v.source + "(";
+            v.source += "(";
+            auto isFirst = true;
+            while (!failed && peek() != ")")
+            {
+                if (!isFirst)
+                {
+                    expect(",");
+                    v.text += ", ";
+                    v.source += ", ";
+                }
+                auto arg = parseAssignment();
+                isFirst = false;
+                v.text += arg.text;
+                v.source += arg.source;
+                v.folds += arg.folds;
+            }
+            expect(")");
+            v.text += ")";
+            v.source += ")";
+        }
+        else if (op == "->" || op == ".")
+        {
+            next();
+            auto member = next();
+            v.text = v.source + op + member;
+            v.source = v.text;
+        }
+        else if (op == "[")
+        {
+            next();
+            auto index = parseAssignment();
+            expect("]");
+            v.text = v.source + "[" + index.text + "]";
+            v.source += "[" + index.source + "]";
+            v.folds += index.folds;
+        }
+        else if (op == "++" || op == "--")
+        {
+            next();
+            v.text = v.source + op;
+            v.source = v.text;
+        }
+        else
+            break;
+
+        v.isConstant = false;
+        v.isFlt = false;
+    }
+
+    return v;
+}
+
+ConstantFolder::Value
+ConstantFolder::parsePrimary()
+{
+    auto token = next();
+    Value v;
+    v.text = token;
+    v.source = token;
+
+    if (token == "(")
+    {
+        // a cast, such as the (float) in front of pow
+        if (isOneOf(peek(), C_TYPES))
+        {
+            auto type = next();
+            while (!failed && peek() != ")")
+                type += (peek() == "*" ? "" : " ") + next();
+            expect(")");
+            auto operand = parseUnary();
+            v.text = "(" + type + ")" + operand.text;
+            v.source = "(" + type + ")" + operand.source;
+            v.folds = operand.folds;
+            return v;
+        }
+
+        auto inner = parseAssignment();
+        expect(")");
+        if (inner.isConstant)
+            return inner;
+
+        inner.text = "(" + inner.text + ")";
+        inner.source = "(" + inner.source + ")";
+        return inner;
+    }
+
+    if (token != "" && (isdigit(token[0]) || token[0] == '.'))
+        return literal(token);
+
+    if (token != "" && (isalpha(token[0]) || token[0] == '_'))
+    {
+        // a variable known to hold a constant, unless it is being called
+        auto value = peek() != "(" ? lookup(token) : "";
+        if (value == "")
+            return v;
+
+        ConstantFolder folder(lookup);
+        folder.failed = !folder.tokenize(value);
+        auto constant = folder.parseAssignment();
+        if (folder.failed || !constant.isConstant)
+            return v;
+
+        constant.source = token;
+        constant.folds = 1;
+        return constant;
+    }
+
+    if (token == "" || token[0] != '"')
+        failed = true;
+    return v;
+}
+
+int
+ConstantFolder::fold(const std::string& expression, std::string& folded,
+                     std::string& value)
+{
+    tokens.clear();
+    current = 0;
+    failed = !tokenize(expression);
+    folded = expression;
+    value = "";
+
+    if (failed || tokens.size() == 0)
+        return 0;
+
+    auto v = parseAssignment();
+    if (failed || current != tokens.size())
+        return 0;
+
+    if (v.isConstant)
+        value = v.text;
+    if (v.folds == 0)
+        return 0;
+
+    folded = v.text;
+    return v.folds;
+}
@@ -0,0 +1,71 @@
+/*
+ * Robert Durst 2019
+ * Sailfish Programming Language
+ *
+ * ConstantFolder rereads an expression the transpiler has already written as C
+ * and replaces each of its constant parts with the literal C would compute for
+ * it. The C text is parsed with C's own precedence, since that is how the
+ * generated code is evaluated. Variables known to hold a constant are looked up
+ * by name. Anything the folder does not understand, such as casts of pointers
+ * or statements, leaves the expression untouched.
+ */
+#pragma once
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+class ConstantFolder
+{
+  private:
+    // a parsed part of the expression: its C text after folding, the same
+    // text without any folding for where C needs the original (the target of
+    // an assignment), and its value if it is constant
+    struct Value
+    {
+        std::string text;
+        std::string source;
+        bool isConstant = false;
+        bool isFlt = false;
+        bool isSingle = false; // a C float rather than a double
+        int32_t i = 0;
+        double f = 0;
+        int folds = 0;
+    };
+
+    std::vector<std::string> tokens;
+    size_t current;
+    bool failed;
+    std::function<std::string(const std::string&)> lookup;
+
+    bool tokenize(const std::string&);
+    std::string peek();
+    std::string next();
+    void expect(const std::string&);
+
+    Value parseAssignment();
+    Value parseBinary(int);
+    Value parseUnary();
+    Value parsePostfix();
+    Value parsePrimary();
+
+    Value literal(const std::string&);
+    Value constant(Value);
+    Value foldBinary(const std::string&, const Value&, const Value&);
+    Value foldUnary(const std::string&, const Value&);
+
+  public:
+    ConstantFolder(const std::function<std::string(const std::string&)>&);
+
+    // folds expression into folded, setting value to its literal if the whole
+    // expression is constant, and returns how many parts were folded
+    int fold(const std::string& expression, std::string& folded,
+             std::string& value);
+
+    // the C literal for a constant
+    static std::string formatInt(int32_t);
+    static std::string formatFlt(double, bool isSingle);
+
+    // the float literal for the value a C float takes when assigned literal
+    static std::string toSingle(const std::string& literal);
+};
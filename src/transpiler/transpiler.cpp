@@ -3,6 +3,11 @@
  * Sailfish Programming Language
  */
 #include "transpiler.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <iomanip>
+#include <sstream>
 
 std::string
 Transpiler::getTabs()
@@ -78,13 +83,16 @@ Transpiler::builtinTypesTranslator(const std::string& type)
         return type;
 }
 
-Transpiler::Transpiler()
+Transpiler::Transpiler(const CompilerOptions& opts)
 {
+    options = opts;
     buffer = "";
     currentTabs = 0;
     decName = "";
     decType = "";
     bufferToAdd = 0;
+    functionHeaderStart = 0;
+    functionBodyStart = 0;
 }
 
 std::string
@@ -103,7 +111,14 @@ Transpiler::clearOpenBeginWriting()
 void
 Transpiler::writeStandardLibrary()
 {
-    output << OUTPUT_HEADER << getStdLibC();
+    output << OUTPUT_HEADER << stdlib_c_INCLUDES;
+
+    // when linking, the runtime lives in a precompiled library so only its
+    // declarations are pulled in
+    if (options.linkRuntime)
+        output << "#include \"" << stdlib_c_RUNTIME_NAME << ".h\"\n";
+    else
+        output << getStdLibC(buffer, options);
 }
 
 void
@@ -111,9 +126,13 @@ Transpiler::write(bool successfulAnalysis)
 {
     if (successfulAnalysis)
     {
+        if (!options.writeOutput)
+            return;
+
         clearOpenBeginWriting();
         writeStandardLibrary();
         output << buffer;
+        compileStats().bytesEmitted += output.tellp();
         output.close();
     }
     else
@@ -175,6 +194,134 @@ Transpiler::popMethod()
     methodAccessStack.pop_back();
 }
 
+int
+Transpiler::getPosition()
+{
+    return buffer.size();
+}
+
+std::string
+Transpiler::getText(int from, int to)
+{
+    return buffer.substr(from, to - from);
+}
+
+void
+Transpiler::replace(int from, int to, const std::string& text)
+{
+    buffer.replace(from, to - from, text);
+}
+
+InlineBodies
+Transpiler::getInlineBodies()
+{
+    return inlineBodies;
+}
+
+void
+Transpiler::addInlineBodies(const InlineBodies& bodies)
+{
+    inlineBodies.insert(bodies.begin(), bodies.end());
+}
+
+// splits the C text of a call to name into its arguments, failing if the
+// text is anything more than the one call
+bool
+Transpiler::splitCallArguments(const std::string& call,
+                               const std::string& name,
+                               std::vector<std::string>& args)
+{
+    if (call.compare(0, name.size() + 1, name + "(") != 0 ||
+        call.back() != ')')
+        return false;
+
+    int depth = 0;
+    bool inString = false;
+    std::string arg = "";
+    for (size_t i = name.size() + 1; i < call.size() - 1; i++)
+    {
+        char c = call[i];
+        if (inString && c == '\\')
+        {
+            arg += c;
+            arg += call[++i];
+            continue;
+        }
+
+        if (c == '"')
+            inString = !inString;
+        else if (!inString && c == '(')
+            ++depth;
+        else if (!inString && c == ')' && --depth < 0)
+            return false;
+
+        if (!inString && depth == 0 && c == ',')
+        {
+            args.push_back(arg);
+            arg = "";
+        }
+        else
+            arg += c;
+    }
+
+    if (depth != 0 || inString)
+        return false;
+
+    if (args.size() != 0 || arg.find_first_not_of(" ") != std::string::npos)
+        args.push_back(arg);
+
+    for (auto& a : args)
+    {
+        a.erase(0, a.find_first_not_of(" "));
+        a.erase(a.find_last_not_of(" ") + 1);
+    }
+    return true;
+}
+
+// an argument which can be copied into an inlined body as often as its
+// parameter appears without changing what the call does
+bool
+isSimpleArgument(const std::string& arg)
+{
+    for (size_t i = 0; i < arg.size(); i++)
+    {
+        if (arg.compare(i, 2, "->") == 0)
+            ++i;
+        else if (!isalnum(arg[i]) && arg[i] != '_' && arg[i] != '.')
+            return false;
+    }
+
+    return arg != "";
+}
+
+// remembers the returned expression of a function whose body is a single
+// return so that its calls can be replaced by it
+void
+Transpiler::addInlineBody(const std::string& name, const std::string& body)
+{
+    // a profiled function keeps its calls so that they are counted
+    if (options.instrument || options.sampleFile != "")
+        return;
+
+    auto front = body.find_first_not_of(" \n");
+    while (front != std::string::npos && body.compare(front, 6, "#line ") == 0)
+        front = body.find_first_not_of(" \n", body.find('\n', front));
+    auto back = body.find_last_not_of(" \n");
+    if (front == std::string::npos || body.compare(front, 7, "return ") != 0 ||
+        body[back] != ';')
+        return;
+
+    auto expression = body.substr(front + 7, back - front - 7);
+    if (expression.find_first_of(";\n{") != std::string::npos)
+        return;
+
+    std::vector<std::string> parameters;
+    for (auto const& parameter : functionParameters)
+        parameters.push_back(std::get<1>(parameter));
+
+    inlineBodies[name] = std::make_tuple(parameters, expression);
+}
+
 void
 Transpiler::genUDTHeader(const std::string& udtname)
 {
@@ -190,6 +337,38 @@ Transpiler::genUDTFooter(const std::string& udtname)
         "//___________END_" + udtname + "_UDT_DEFINITION__________/_//\n\n";
 }
 
+// instances are recycled through a free list, see POOL in Alloc.h
+void
+Transpiler::genUDTPool(const std::string& udtname)
+{
+    auto pool = udtname + "_pool";
+    buffer += "\nstatic void* " + pool + " = NULL;\n"
+              "\nstatic inline struct " + udtname + "*"
+              "\n" + udtname + "_alloc(void)"
+              "\n{"
+              "\n    void* instance = " + pool + ";"
+              "\n    if (instance == NULL)"
+              "\n        instance = refillPool(&" + pool + ", sizeof(struct " +
+              udtname + "));"
+              "\n    " + pool + " = *(void**)instance;"
+              "\n    return instance;"
+              "\n}\n"
+              "\nstatic inline void"
+              "\n" + udtname + "_release(struct " + udtname + "* instance)"
+              "\n{"
+              "\n    if (instance == NULL)"
+              "\n        return;"
+              "\n    *(void**)instance = " + pool + ";"
+              "\n    " + pool + " = instance;"
+              "\n}\n\n";
+}
+
+void
+Transpiler::genUDTRelease(const std::string& udtname, const std::string& name)
+{
+    buffer += udtname + "_release(" + name + ")";
+}
+
 void
 Transpiler::genLeftCurley()
 {
@@ -240,9 +419,227 @@ Transpiler::genTypeAndNameNewLine(const std::string& type,
     genSemiColonAndNewline();
 }
 
+// every function but main is local to out.c, which lets the C compiler
+// inline and drop them; a function or method the program never calls is not
+// worth a warning
+void
+Transpiler::genFunctionHeader(const std::string& output,
+                              const std::string& name,
+                              const std::string& parameters)
+{
+    functionHeaderStart = buffer.size();
+    buffer += "static __attribute__((unused)) " + output + "\n" + name + "(" +
+              parameters + ")\n";
+}
+
+// escapes text for a C string literal
+std::string
+cString(const std::string& text)
+{
+    std::string escaped = "\"";
+    for (auto c : text)
+    {
+        if (c == '"' || c == '\\')
+            escaped += '\\';
+        escaped += c;
+    }
+    return escaped + "\"";
+}
+
+// with the instrument option every function counts and times its calls in a
+// ProfileSite of its own, named and located as in the Sailfish source; the
+// cleanup of profileCall closes the call on every return. When sampling, it
+// pushes its name on the runtime's stack the same way
 void
-Transpiler::genFunctionEnd()
+Transpiler::genProfileEntry(const std::string& name, const std::string& file,
+                            int line)
 {
+    if (options.instrument)
+        buffer += "\n    static ProfileSite profileSite = {" + cString(name) +
+                  ", " + cString(file) + ", " + std::to_string(line) + "};" +
+                  "\n    ProfileSite* profileCall "
+                  "__attribute__((cleanup(profileExit))) = "
+                  "profileEnter(&profileSite);\n";
+
+    if (options.sampleFile != "")
+        buffer += "\n    int sampleCall __attribute__((cleanup(sampleExit))) = "
+                  "sampleEnter(" + cString(name) + ");\n";
+}
+
+// gcc, gdb and perf then report statements at their place in the Sailfish
+// source rather than in out.c; the statement header ends the directive's line
+void
+Transpiler::genLineDirective(int line, const std::string& file)
+{
+    if (options.lineDirectives)
+        buffer += "\n" + getTabs() + "#line " + std::to_string(line) + " " +
+                  cString(file);
+}
+
+// with --profile-generate a Tree counts how often it is reached before its
+// first guard and each branch how often it is taken at the top of its block
+void
+Transpiler::genBranchCount(const std::string& file, int line, int column,
+                           int branch)
+{
+    if (options.profileGenerateFile == "")
+        return;
+
+    auto site = "{ static BranchSite branchSite = {" + cString(file) + ", " +
+                std::to_string(line) + ", " + std::to_string(column) + ", " +
+                std::to_string(branch) + "}; countBranch(&branchSite); }";
+    if (branch == 0)
+        buffer += site + "\n" + getTabs();
+    else
+        buffer += "\n" + getTabs() + "    " + site;
+}
+
+void
+Transpiler::genFunctionBodyStart(
+    const std::vector<std::tuple<std::string, std::string>>& parameters)
+{
+    functionBodyStart = buffer.size();
+    functionParameters = parameters;
+}
+
+// Sailfish iterates by recursion, so a function calling itself as its last
+// act is rewritten into assigning the call's arguments to its parameters and
+// jumping back to the top of the body. Each span is a statement holding only
+// the call, or a return of it.
+void
+Transpiler::genTailCalls(const std::string& name,
+                         std::vector<std::tuple<int, int>> spans)
+{
+    // rewrite back to front so the earlier spans stay where they are
+    std::sort(spans.rbegin(), spans.rend());
+
+    bool rewritten = false;
+    for (auto const& span : spans)
+    {
+        auto start = std::get<0>(span);
+        auto call = buffer.substr(start, std::get<1>(span) - start);
+        if (call.compare(0, 7, "return ") == 0)
+            call = call.substr(7);
+
+        std::vector<std::string> args;
+        if (!splitCallArguments(call, name, args) ||
+            args.size() != functionParameters.size())
+            continue;
+
+        auto lineStart = buffer.rfind('\n', start) + 1;
+        auto tabs = buffer.substr(lineStart, start - lineStart);
+
+        // evaluate every argument before assigning any parameter
+        std::string loop = "{";
+        for (size_t i = 0; i < args.size(); i++)
+        {
+            auto parameter = std::get<1>(functionParameters[i]);
+            if (args[i] != parameter)
+                loop += "\n" + tabs + "    " +
+                        std::get<0>(functionParameters[i]) + " tail_" +
+                        parameter + " = " + args[i] + ";";
+        }
+        for (size_t i = 0; i < args.size(); i++)
+        {
+            auto parameter = std::get<1>(functionParameters[i]);
+            if (args[i] != parameter)
+                loop += "\n" + tabs + "    " + parameter + " = tail_" +
+                        parameter + ";";
+        }
+        loop += "\n" + tabs + "    goto tail_call;\n" + tabs + "}";
+
+        buffer.replace(start, std::get<1>(span) - start, loop);
+        rewritten = true;
+    }
+
+    if (rewritten)
+        buffer.insert(functionBodyStart, "\ntail_call:;");
+}
+
+// with the inline option a call to a function whose body is a single return
+// is replaced by the returned expression, its parameters substituted by the
+// call's arguments; the call must end the buffer and begin at start
+bool
+Transpiler::genInlineCall(const std::string& name, int start)
+{
+    auto body = inlineBodies.find(name);
+    if (!options.inlineCalls || body == inlineBodies.end())
+        return false;
+
+    auto parameters = std::get<0>(body->second);
+    auto expression = std::get<1>(body->second);
+
+    std::vector<std::string> args;
+    if (!splitCallArguments(buffer.substr(start), name, args) ||
+        args.size() != parameters.size())
+        return false;
+
+    std::vector<int> uses(args.size(), 0);
+    std::string inlined = "";
+    size_t i = 0;
+    while (i < expression.size())
+    {
+        auto c = expression[i];
+        auto end = i + 1;
+        if (c == '"')
+        {
+            while (end < expression.size() && expression[end] != '"')
+                end += (expression[end] == '\\') ? 2 : 1;
+            ++end;
+        }
+        else if (isalnum(c) || c == '_')
+        {
+            while (end < expression.size() &&
+                   (isalnum(expression[end]) || expression[end] == '_'))
+                ++end;
+        }
+
+        auto token = expression.substr(i, end - i);
+        auto parameter =
+            std::find(parameters.begin(), parameters.end(), token);
+
+        // attribute names are left alone even if a parameter shares them
+        auto isAttribute =
+            (inlined.size() > 0 && inlined.back() == '.') ||
+            (inlined.size() > 1 &&
+             inlined.compare(inlined.size() - 2, 2, "->") == 0);
+
+        if (parameter != parameters.end() && !isAttribute)
+        {
+            auto index = parameter - parameters.begin();
+            ++uses[index];
+            if (isSimpleArgument(args[index]))
+                inlined += args[index];
+            else
+                inlined += "(" + args[index] + ")";
+        }
+        else
+            inlined += token;
+
+        i = end;
+    }
+
+    // arguments with effects must be evaluated exactly once
+    for (size_t a = 0; a < args.size(); a++)
+        if (uses[a] != 1 && !isSimpleArgument(args[a]))
+            return false;
+
+    buffer.replace(start, std::string::npos, "(" + inlined + ")");
+    return true;
+}
+
+void
+Transpiler::genFunctionEnd(const std::string& name)
+{
+    auto body = buffer.substr(functionBodyStart);
+
+    // small bodies which don't loop on themselves are worth inlining
+    if (occurences(body, ";\n") <= INLINE_STATEMENT_LIMIT &&
+        body.find("tail_call:") == std::string::npos)
+        buffer.insert(functionHeaderStart + std::string("static ").size(),
+                      "inline ");
+
+    addInlineBody(name, body);
     buffer += "\n}\n\n";
 }
 
@@ -250,6 +647,15 @@ void
 Transpiler::genMainHeader()
 {
     buffer += "int\nmain()\n{";
+    if (options.lineBuffered)
+        buffer += "\n    setLineBuffered(1);";
+    if (options.arenaAllocation)
+        buffer += "\n    setArenaAllocation(1);";
+    if (options.sampleFile != "")
+        buffer += "\n    startSampling(" + cString(options.sampleFile) + ");";
+    if (options.profileGenerateFile != "")
+        buffer += "\n    startBranchProfile(" +
+                  cString(options.profileGenerateFile) + ");";
 }
 
 void
@@ -308,6 +714,123 @@ Transpiler::genOperator(const std::string& op)
     buffer += " " + op + " ";
 }
 
+bool
+isIntLiteral(const std::string& s)
+{
+    return s != "" && s.size() < 10 &&
+           s.find_first_not_of("0123456789") == std::string::npos;
+}
+
+bool
+isFltLiteral(const std::string& s)
+{
+    return s != "" && s.find_first_not_of("0123456789.") == std::string::npos &&
+           std::count(s.begin(), s.end(), '.') == 1;
+}
+
+// ** has no C operator: the base and exponent, already written from baseStart
+// and exponentStart, are replaced by their folded value, a multiplication for
+// small constant exponents, or a call into the runtime. Like powInt, folded
+// int powers wrap on overflow.
+void
+Transpiler::genPower(int baseStart, int exponentStart, bool isFlt)
+{
+    auto trim = [](std::string s) {
+        s.erase(0, s.find_first_not_of(" "));
+        s.erase(s.find_last_not_of(" ") + 1);
+        return s;
+    };
+    auto base = trim(buffer.substr(baseStart, exponentStart - baseStart));
+    auto exponent = trim(buffer.substr(exponentStart));
+    buffer.erase(baseStart);
+
+    if (!isFlt)
+    {
+        if (isIntLiteral(base) && isIntLiteral(exponent))
+        {
+            uint32_t result = 1;
+            uint32_t square = std::stoul(base);
+            for (auto n = std::stoul(exponent); n > 0; n >>= 1)
+            {
+                if (n & 1)
+                    result *= square;
+                square *= square;
+            }
+            auto literal = std::to_string((int32_t)result);
+            buffer += (int32_t)result < 0 ? "(" + literal + ")" : literal;
+        }
+        else if (exponent == "0" && isSimpleArgument(base))
+            buffer += "1";
+        else if (exponent == "1" && isSimpleArgument(base))
+            buffer += base;
+        else if (exponent == "2" && isSimpleArgument(base))
+            buffer += "(" + base + " * " + base + ")";
+        else
+            buffer += "powInt(" + base + ", " + exponent + ")";
+        return;
+    }
+
+    // an exponent such as 3.0 is raised to by squaring, as powFlt does,
+    // anything else by pow
+    auto isIntegral = isFltLiteral(exponent) &&
+                      std::stod(exponent) == std::floor(std::stod(exponent)) &&
+                      std::stod(exponent) < 2147483648.0;
+
+    if (isFltLiteral(base) && isFltLiteral(exponent))
+    {
+        double result = 1.0;
+        double square = (float)std::stod(base);
+        if (isIntegral)
+        {
+            for (auto n = (long)std::stod(exponent); n > 0; n >>= 1)
+            {
+                if (n & 1)
+                    result *= square;
+                square *= square;
+            }
+        }
+        else
+            result = std::pow(square, std::stod(exponent));
+
+        std::ostringstream literal;
+        literal << std::setprecision(9) << (float)result;
+        if (std::isfinite((float)result))
+        {
+            buffer += literal.str();
+            if (literal.str().find_first_of(".e") == std::string::npos)
+                buffer += ".0";
+            return;
+        }
+    }
+
+    if (isIntegral && std::stod(exponent) == 2 && isSimpleArgument(base))
+        buffer += "(" + base + " * " + base + ")";
+    else if (isIntegral)
+        buffer += "powFlt(" + base + ", " +
+                  std::to_string((long)std::stod(exponent)) + ")";
+    else
+        buffer += "(float)pow(" + base + ", " + exponent + ")";
+}
+
+// folds the constant parts of the expression written since start, see
+// ConstantFolder, returning its literal value if it is constant as a whole
+std::string
+Transpiler::genFoldedExpression(
+    int start, const std::function<std::string(const std::string&)>& lookup)
+{
+    std::string folded;
+    std::string value;
+    ConstantFolder folder(lookup);
+    auto folds = folder.fold(buffer.substr(start), folded, value);
+    if (folds > 0)
+    {
+        buffer.replace(start, std::string::npos, folded);
+        compileStats().foldedExpressions += folds;
+    }
+
+    return value;
+}
+
 void
 Transpiler::genAttributeAccess(bool nextIsTripleDot, bool udtNameIsUDT,
                                const std::string& udtname,
@@ -344,8 +867,7 @@ Transpiler::genAttributeAccess(bool nextIsTripleDot, bool udtNameIsUDT,
 void
 Transpiler::genUDTDecInit(const std::string& udtname)
 {
-    buffer +=
-        "(struct " + udtname + "*)malloc(sizeof(struct " + udtname + "));\n";
+    buffer += udtname + "_alloc();\n";
 }
 
 void
@@ -363,8 +885,10 @@ Transpiler::genLiteral(const std::string& literal)
 void
 Transpiler::genListInit(const std::string& type, const std::string size)
 {
-    buffer += "(" + builtinTypesTranslator(type) + "*)malloc(sizeof(" +
-              builtinTypesTranslator(type) + ") * " + size + ");\n";
+    // lists carry their length and capacity in a header in front of the
+    // elements, see newList in Lists.h
+    buffer += "(" + builtinTypesTranslator(type) + "*)newList(" + size +
+              ", sizeof(" + builtinTypesTranslator(type) + "));\n";
 }
 
 void
@@ -3,13 +3,24 @@
  * Sailfish Programming Language
  */
 #pragma once
+#include "../common/CompileStats.h"
+#include "../common/CompilerOptions.h"
 #include "../stdlib_c/stdlib_c.h"
+#include "ConstantFolder.h"
 #include <fstream>
+#include <functional>
 #include <iostream>
 #include <string>
 #include <tuple>
+#include <unordered_map>
 #include <vector>
 
+// the parameter names and returned C expression of a function whose body is
+// a single return, keyed by function name
+using InlineBodies =
+    std::unordered_map<std::string,
+                       std::tuple<std::vector<std::string>, std::string>>;
+
 class Transpiler
 {
   private:
@@ -22,6 +33,11 @@ class Transpiler
     int currentTabs;
     std::ofstream output;
     int bufferToAdd;
+    CompilerOptions options;
+    int functionHeaderStart;
+    int functionBodyStart;
+    std::vector<std::tuple<std::string, std::string>> functionParameters;
+    InlineBodies inlineBodies;
 
     // methods
     std::string getTabs();
@@ -30,8 +46,12 @@ class Transpiler
     std::string extractChainAAType(const std::string&);
     int occurences(const std::string&, const std::string&);
     std::string builtinTypesTranslator(const std::string&);
+    bool splitCallArguments(const std::string&, const std::string&,
+                            std::vector<std::string>&);
+    void addInlineBody(const std::string&, const std::string&);
 
     // consts
+    const int INLINE_STATEMENT_LIMIT = 2;
     const std::string OUTPUT_HEADER =
         "/**"
         "\n * Do not alter! This code is generated by the sailfishc"
@@ -52,14 +72,10 @@ class Transpiler
         "\n *"
         "\n * \"Many men go fishing all their lives without knowing it is"
         "\n * not the fish they are after\" - Henry David Thoreau\n */"
-        "\n"
-        "\n#include <stdio.h>"
-        "\n#include <stdlib.h>"
-        "\n#include <string.h>"
         "\n";
 
   public:
-    Transpiler();
+    Transpiler(const CompilerOptions&);
 
     // utility methods
     std::string getBuffer();
@@ -73,10 +89,17 @@ class Transpiler
     std::string getDecType();
     void pushMethod(const std::string&, const std::string&);
     void popMethod();
+    int getPosition();
+    std::string getText(int, int);
+    void replace(int, int, const std::string&);
+    InlineBodies getInlineBodies();
+    void addInlineBodies(const InlineBodies&);
 
     // transpilation methods
     void genUDTHeader(const std::string&);
     void genUDTFooter(const std::string&);
+    void genUDTPool(const std::string&);
+    void genUDTRelease(const std::string&, const std::string&);
     void genLeftCurley();
     void genRightCurley();
     void genLeftParen();
@@ -85,7 +108,17 @@ class Transpiler
     void genSemiColonAndNewline();
     void genTypeAndName(const std::string&, const std::string&);
     void genTypeAndNameNewLine(const std::string&, const std::string&);
-    void genFunctionEnd();
+    void genFunctionHeader(const std::string&, const std::string&,
+                           const std::string&);
+    void genProfileEntry(const std::string&, const std::string&, int);
+    void genLineDirective(int, const std::string&);
+    void genBranchCount(const std::string&, int, int, int);
+    void genFunctionBodyStart(
+        const std::vector<std::tuple<std::string, std::string>>&);
+    void genTailCalls(const std::string&,
+                      std::vector<std::tuple<int, int>>);
+    bool genInlineCall(const std::string&, int);
+    void genFunctionEnd(const std::string&);
     void genMainHeader();
     void genMainFooter();
     void genStatementHeader();
@@ -96,6 +129,10 @@ class Transpiler
     void genBranchFooter();
     void genReturn();
     void genOperator(const std::string&);
+    void genPower(int, int, bool);
+    std::string
+    genFoldedExpression(int,
+                        const std::function<std::string(const std::string&)>&);
     void genAttributeAccess(bool, bool, const std::string&, const std::string&);
     void genUDTDecInit(const std::string&);
     void genUDTDecItem(const std::string&);
@@ -0,0 +1,560 @@
+/*
+ * Robert Durst 2019
+ * Sailfish Programming Language
+ */
+#include "Builtins.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace
+{
+Value
+none()
+{
+    Value v;
+    v.p = nullptr;
+    return v;
+}
+
+Value
+integer(int32_t i)
+{
+    Value v;
+    v.p = nullptr;
+    v.i = i;
+    return v;
+}
+
+Value
+single(float f)
+{
+    Value v;
+    v.f = f;
+    return v;
+}
+
+Value
+pointer(void* p)
+{
+    Value v;
+    v.p = p;
+    return v;
+}
+
+List*
+list(const Value& v)
+{
+    return static_cast<List*>(v.p);
+}
+
+size_t
+length(const Value& v)
+{
+    return v.p == nullptr ? 0 : list(v)->items.size();
+}
+
+// -------- printing, formatted as in Output.h -------- //
+
+// writes the digits of value ending just before end, returning the start
+char*
+formatDigits(char* end, unsigned long long value, int minDigits)
+{
+    do
+    {
+        *--end = (char)('0' + value % 10);
+        value /= 10;
+        minDigits--;
+    } while (value != 0 || minDigits > 0);
+    return end;
+}
+
+void
+printInt(Output& out, int32_t i)
+{
+    char text[16];
+    uint32_t magnitude = i < 0 ? 0u - (uint32_t)i : (uint32_t)i;
+    char* start = formatDigits(text + sizeof(text), magnitude, 1);
+    if (i < 0)
+        *--start = '-';
+    out.writeLine(start, text + sizeof(text) - start);
+}
+
+// like printf's "%f": a float times 1e6 is exact in a double, so rounding the
+// scaled value half to even gives the same six decimals
+void
+printFlt(Output& out, float f)
+{
+    char text[64];
+    double scaled = (double)f * 1e6;
+    bool negative = std::signbit(f);
+
+    if (!(f > -1e12f && f < 1e12f))
+    {
+        out.writeLine(text, snprintf(text, sizeof(text), "%f", f));
+        return;
+    }
+
+    if (negative)
+        scaled = -scaled;
+    auto units = (unsigned long long)scaled;
+    double fraction = scaled - (double)units;
+    if (fraction > 0.5 || (fraction == 0.5 && units % 2 == 1))
+        units++;
+
+    char* start = formatDigits(text + sizeof(text), units % 1000000, 6);
+    *--start = '.';
+    start = formatDigits(start, units / 1000000, 1);
+    if (negative)
+        *--start = '-';
+    out.writeLine(start, text + sizeof(text) - start);
+}
+
+void
+printStr(Output& out, const Value& s)
+{
+    auto text = static_cast<const char*>(s.p);
+    out.writeLine(text, strlen(text));
+}
+
+void
+printBool(Output& out, int32_t i)
+{
+    if (i == 0)
+        out.writeLine("false", 5);
+    else
+        out.writeLine("true", 4);
+}
+
+Value
+printIntBuiltin(VM& vm, Value* args)
+{
+    printInt(vm.getOutput(), args[0].i);
+    return none();
+}
+
+Value
+printFltBuiltin(VM& vm, Value* args)
+{
+    printFlt(vm.getOutput(), (float)args[0].f);
+    return none();
+}
+
+Value
+printStrBuiltin(VM& vm, Value* args)
+{
+    printStr(vm.getOutput(), args[0]);
+    return none();
+}
+
+Value
+printBoolBuiltin(VM& vm, Value* args)
+{
+    printBool(vm.getOutput(), args[0].i);
+    return none();
+}
+
+Value
+printListInt(VM& vm, Value* args)
+{
+    for (size_t i = 0; i < length(args[0]); ++i)
+        printInt(vm.getOutput(), list(args[0])->items[i].i);
+    return none();
+}
+
+Value
+printListFlt(VM& vm, Value* args)
+{
+    for (size_t i = 0; i < length(args[0]); ++i)
+        printFlt(vm.getOutput(), (float)list(args[0])->items[i].f);
+    return none();
+}
+
+Value
+printListStr(VM& vm, Value* args)
+{
+    for (size_t i = 0; i < length(args[0]); ++i)
+        printStr(vm.getOutput(), list(args[0])->items[i]);
+    return none();
+}
+
+Value
+printListBool(VM& vm, Value* args)
+{
+    for (size_t i = 0; i < length(args[0]); ++i)
+        printBool(vm.getOutput(), list(args[0])->items[i].i);
+    return none();
+}
+
+// -------- lists, as in Lists.h; the size arguments are ignored -------- //
+
+Value
+len(VM&, Value* args)
+{
+    return integer((int32_t)length(args[0]));
+}
+
+// extendList, and appendList, which also frees its second list in C
+Value
+extendList(VM& vm, Value* args)
+{
+    auto a = args[0].p == nullptr ? vm.newList() : list(args[0]);
+    if (args[1].p != nullptr)
+    {
+        auto b = list(args[1])->items;
+        a->items.insert(a->items.end(), b.begin(), b.end());
+    }
+    return pointer(a);
+}
+
+Value
+pushList(VM& vm, Value* args)
+{
+    auto a = args[0].p == nullptr ? vm.newList() : list(args[0]);
+    a->items.push_back(args[2]);
+    return pointer(a);
+}
+
+// removeAtIndex and deleteAtIndex
+Value
+removeAtIndex(VM&, Value* args)
+{
+    auto index = args[2].i;
+    if (index < 0 || (size_t)index >= length(args[0]))
+        return args[0];
+
+    auto& items = list(args[0])->items;
+    items.erase(items.begin() + index);
+    return args[0];
+}
+
+Value
+removeRange(VM&, Value* args)
+{
+    auto index = args[2].i;
+    auto count = args[3].i;
+    auto n = (int32_t)length(args[0]);
+    if (index < 0 || count <= 0 || index >= n)
+        return args[0];
+    count = std::min(count, n - index);
+
+    auto& items = list(args[0])->items;
+    items.erase(items.begin() + index, items.begin() + index + count);
+    return args[0];
+}
+
+Value
+getAtIndex(VM& vm, Value* args)
+{
+    vm.checkIndex(list(args[0]), args[1].i);
+    return list(args[0])->items[args[1].i];
+}
+
+Value
+setAtIndex(VM& vm, Value* args)
+{
+    vm.checkIndex(list(args[0]), args[1].i);
+    list(args[0])->items[args[1].i] = args[2];
+    return args[0];
+}
+
+// -------- kernels, the scalar versions in Kernels.h -------- //
+
+Value
+sumListInt(VM&, Value* args)
+{
+    uint32_t total = 0;
+    for (size_t i = 0; i < length(args[0]); ++i)
+        total += (uint32_t)list(args[0])->items[i].i;
+    return integer((int32_t)total);
+}
+
+Value
+sumListFlt(VM&, Value* args)
+{
+    float total = 0;
+    for (size_t i = 0; i < length(args[0]); ++i)
+        total += (float)list(args[0])->items[i].f;
+    return single(total);
+}
+
+Value
+minListInt(VM&, Value* args)
+{
+    if (length(args[0]) == 0)
+        return integer(0);
+    auto& items = list(args[0])->items;
+    auto best = items[0].i;
+    for (size_t i = 1; i < items.size(); ++i)
+        if (items[i].i < best)
+            best = items[i].i;
+    return integer(best);
+}
+
+Value
+maxListInt(VM&, Value* args)
+{
+    if (length(args[0]) == 0)
+        return integer(0);
+    auto& items = list(args[0])->items;
+    auto best = items[0].i;
+    for (size_t i = 1; i < items.size(); ++i)
+        if (items[i].i > best)
+            best = items[i].i;
+    return integer(best);
+}
+
+Value
+minListFlt(VM&, Value* args)
+{
+    if (length(args[0]) == 0)
+        return single(0);
+    auto& items = list(args[0])->items;
+    auto best = (float)items[0].f;
+    for (size_t i = 1; i < items.size(); ++i)
+        if ((float)items[i].f < best)
+            best = (float)items[i].f;
+    return single(best);
+}
+
+Value
+maxListFlt(VM&, Value* args)
+{
+    if (length(args[0]) == 0)
+        return single(0);
+    auto& items = list(args[0])->items;
+    auto best = (float)items[0].f;
+    for (size_t i = 1; i < items.size(); ++i)
+        if ((float)items[i].f > best)
+            best = (float)items[i].f;
+    return single(best);
+}
+
+Value
+dotListInt(VM&, Value* args)
+{
+    auto n = std::min(length(args[0]), length(args[1]));
+    uint32_t total = 0;
+    for (size_t i = 0; i < n; ++i)
+        total += (uint32_t)list(args[0])->items[i].i *
+                 (uint32_t)list(args[1])->items[i].i;
+    return integer((int32_t)total);
+}
+
+Value
+dotListFlt(VM&, Value* args)
+{
+    auto n = std::min(length(args[0]), length(args[1]));
+    float total = 0;
+    for (size_t i = 0; i < n; ++i)
+    {
+        float product =
+            (float)list(args[0])->items[i].f * (float)list(args[1])->items[i].f;
+        total += product;
+    }
+    return single(total);
+}
+
+Value
+scaleListInt(VM&, Value* args)
+{
+    for (size_t i = 0; i < length(args[0]); ++i)
+    {
+        auto& item = list(args[0])->items[i];
+        item.i = (int32_t)((uint32_t)item.i * (uint32_t)args[1].i);
+    }
+    return args[0];
+}
+
+Value
+scaleListFlt(VM&, Value* args)
+{
+    for (size_t i = 0; i < length(args[0]); ++i)
+    {
+        auto& item = list(args[0])->items[i];
+        item.f = (float)item.f * (float)args[1].f;
+    }
+    return args[0];
+}
+
+Value
+addListInt(VM&, Value* args)
+{
+    auto n = std::min(length(args[0]), length(args[1]));
+    for (size_t i = 0; i < n; ++i)
+    {
+        auto& item = list(args[0])->items[i];
+        item.i = (int32_t)((uint32_t)item.i +
+                           (uint32_t)list(args[1])->items[i].i);
+    }
+    return args[0];
+}
+
+Value
+addListFlt(VM&, Value* args)
+{
+    auto n = std::min(length(args[0]), length(args[1]));
+    for (size_t i = 0; i < n; ++i)
+    {
+        auto& item = list(args[0])->items[i];
+        item.f = (float)item.f + (float)list(args[1])->items[i].f;
+    }
+    return args[0];
+}
+
+// fillListInt and fillListFlt, whose value is already what the list holds
+Value
+fillList(VM&, Value* args)
+{
+    for (size_t i = 0; i < length(args[0]); ++i)
+        list(args[0])->items[i] = args[1];
+    return args[0];
+}
+
+// -------- sorting, ascending as in Sort.h -------- //
+
+Value
+sortListInt(VM&, Value* args)
+{
+    if (args[0].p != nullptr)
+    {
+        auto& items = list(args[0])->items;
+        std::sort(items.begin(), items.end(),
+                  [](const Value& a, const Value& b) { return a.i < b.i; });
+    }
+    return args[0];
+}
+
+Value
+sortListFlt(VM&, Value* args)
+{
+    if (args[0].p != nullptr)
+    {
+        auto& items = list(args[0])->items;
+        std::sort(items.begin(), items.end(),
+                  [](const Value& a, const Value& b) { return a.f < b.f; });
+    }
+    return args[0];
+}
+
+Value
+sortListStr(VM&, Value* args)
+{
+    if (args[0].p != nullptr)
+    {
+        auto& items = list(args[0])->items;
+        std::sort(items.begin(), items.end(),
+                  [](const Value& a, const Value& b) {
+                      return strcmp(static_cast<const char*>(a.p),
+                                    static_cast<const char*>(b.p)) < 0;
+                  });
+    }
+    return args[0];
+}
+
+// -------- the arena, which --run does not use -------- //
+
+Value
+arenaMark(VM&, Value*)
+{
+    return integer(0);
+}
+
+Value
+arenaRelease(VM&, Value*)
+{
+    return none();
+}
+} // namespace
+
+const std::vector<Builtin>&
+getBuiltins()
+{
+    static const std::vector<Builtin> builtins = {
+        {"appendListInt", "F(_[int]_[int]_int_int)[int]", extendList},
+        {"appendListStr", "F(_[str]_[str]_int_int)[str]", extendList},
+        {"appendListBool", "F(_[bool]_[bool]_int_int)[bool]", extendList},
+        {"appendListFlt", "F(_[flt]_[flt]_int_int)[flt]", extendList},
+
+        {"pushListInt", "F(_[int]_int_int)[int]", pushList},
+        {"pushListStr", "F(_[str]_int_str)[str]", pushList},
+        {"pushListBool", "F(_[bool]_int_bool)[bool]", pushList},
+        {"pushListFlt", "F(_[flt]_int_flt)[flt]", pushList},
+
+        {"extendListInt", "F(_[int]_[int]_int_int)[int]", extendList},
+        {"extendListStr", "F(_[str]_[str]_int_int)[str]", extendList},
+        {"extendListBool", "F(_[bool]_[bool]_int_int)[bool]", extendList},
+        {"extendListFlt", "F(_[flt]_[flt]_int_int)[flt]", extendList},
+
+        {"deleteAtIndexInt", "F(_[int]_int_int)[int]", removeAtIndex},
+        {"deleteAtIndexStr", "F(_[str]_int_int)[str]", removeAtIndex},
+        {"deleteAtIndexBool", "F(_[bool]_int_int)[bool]", removeAtIndex},
+        {"deleteAtIndexFlt", "F(_[flt]_int_int)[flt]", removeAtIndex},
+
+        {"removeAtIndexInt", "F(_[int]_int_int)[int]", removeAtIndex},
+        {"removeAtIndexStr", "F(_[str]_int_int)[str]", removeAtIndex},
+        {"removeAtIndexBool", "F(_[bool]_int_int)[bool]", removeAtIndex},
+        {"removeAtIndexFlt", "F(_[flt]_int_int)[flt]", removeAtIndex},
+
+        {"removeRangeInt", "F(_[int]_int_int_int)[int]", removeRange},
+        {"removeRangeStr", "F(_[str]_int_int_int)[str]", removeRange},
+        {"removeRangeBool", "F(_[bool]_int_int_int)[bool]", removeRange},
+        {"removeRangeFlt", "F(_[flt]_int_int_int)[flt]", removeRange},
+
+        {"getAtIndexInt", "F(_[int]_int)int", getAtIndex},
+        {"getAtIndexStr", "F(_[str]_int)str", getAtIndex},
+        {"getAtIndexBool", "F(_[bool]_int)bool", getAtIndex},
+        {"getAtIndexFlt", "F(_[flt]_int)flt", getAtIndex},
+
+        {"setAtIndexInt", "F(_[int]_int_int)[int]", setAtIndex},
+        {"setAtIndexStr", "F(_[str]_int_str)[str]", setAtIndex},
+        {"setAtIndexBool", "F(_[bool]_int_bool)[bool]", setAtIndex},
+        {"setAtIndexFlt", "F(_[flt]_int_flt)[flt]", setAtIndex},
+
+        {"len", "F(_[any])int", len},
+
+        {"sumListInt", "F(_[int])int", sumListInt},
+        {"sumListFlt", "F(_[flt])flt", sumListFlt},
+        {"minListInt", "F(_[int])int", minListInt},
+        {"minListFlt", "F(_[flt])flt", minListFlt},
+        {"maxListInt", "F(_[int])int", maxListInt},
+        {"maxListFlt", "F(_[flt])flt", maxListFlt},
+        {"dotListInt", "F(_[int]_[int])int", dotListInt},
+        {"dotListFlt", "F(_[flt]_[flt])flt", dotListFlt},
+        {"scaleListInt", "F(_[int]_int)[int]", scaleListInt},
+        {"scaleListFlt", "F(_[flt]_flt)[flt]", scaleListFlt},
+        {"addListInt", "F(_[int]_[int])[int]", addListInt},
+        {"addListFlt", "F(_[flt]_[flt])[flt]", addListFlt},
+        {"fillListInt", "F(_[int]_int)[int]", fillList},
+        {"fillListFlt", "F(_[flt]_flt)[flt]", fillList},
+
+        {"sortListInt", "F(_[int])[int]", sortListInt},
+        {"sortListFlt", "F(_[flt])[flt]", sortListFlt},
+        {"sortListStr", "F(_[str])[str]", sortListStr},
+
+        {"arenaMark", "F(_void)int", arenaMark},
+        {"arenaRelease", "F(_int)void", arenaRelease},
+        {"resetArena", "F(_void)void", arenaRelease},
+
+        {"printInt", "F(_int)void", printIntBuiltin},
+        {"printStr", "F(_str)void", printStrBuiltin},
+        {"printBool", "F(_bool)void", printBoolBuiltin},
+        {"printFlt", "F(_flt)void", printFltBuiltin},
+
+        {"printListInt", "F(_[int])void", printListInt},
+        {"printListStr", "F(_[str])void", printListStr},
+        {"printListBool", "F(_[bool])void", printListBool},
+        {"printListFlt", "F(_[flt])void", printListFlt},
+    };
+    return builtins;
+}
+
+int
+findBuiltin(const std::string& name)
+{
+    auto& builtins = getBuiltins();
+    for (size_t i = 0; i < builtins.size(); ++i)
+        if (builtins[i].name == name)
+            return (int)i;
+    return -1;
+}
@@ -0,0 +1,29 @@
+/*
+ * Robert Durst 2019
+ * Sailfish Programming Language
+ *
+ * The stdlib for --run: every builtin the SymbolTable declares, with the same
+ * signature, doing what its C in stdlib_c does. Kernels are the plain C
+ * versions, as if SAILFISH_SIMD=0, so flt sums add in order. Without --arena
+ * the arena builtins do nothing, and --run never uses an arena.
+ */
+#pragma once
+#include "Bytecode.h"
+#include "VM.h"
+#include <string>
+#include <vector>
+
+// a builtin reads its arguments from consecutive registers
+using BuiltinFunction = Value (*)(VM&, Value*);
+
+struct Builtin
+{
+    std::string name;
+    std::string signature; // as in SymbolTable::addBuiltins
+    BuiltinFunction function;
+};
+
+const std::vector<Builtin>& getBuiltins();
+
+// the index of the builtin with the name, or -1
+int findBuiltin(const std::string& name);
@@ -0,0 +1,155 @@
+/*
+ * Robert Durst 2019
+ * Sailfish Programming Language
+ *
+ * The bytecode --run executes instead of going through C. Every function has a
+ * frame of registers, its parameters first, and each instruction names the
+ * registers it reads and writes. Types are known when lowering, so there is
+ * an instruction for each operation on each type rather than tagged values,
+ * and values are kept as C keeps them: ints wrap at 32 bits and flts are
+ * rounded to a C float whenever C would store one.
+ */
+#pragma once
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <utility>
+#include <vector>
+
+enum class Op : uint16_t
+{
+    MOVE,     // a = b
+    LOADI,    // a = the int immediate
+    LOADF,    // a = floats[immediate]
+    LOADS,    // a = strings[immediate]
+    LOADNULL, // a = empty
+    LOADLIST, // a = a new copy of lists[immediate]
+
+    // ints, wrapping; ADDIK adds the signed 16 bit c itself
+    ADDI,
+    SUBI,
+    MULI,
+    DIVI,
+    MODI,
+    ADDIK,
+    POWI,
+
+    // flts, computed in double like C computes with a double literal; ROUNDF
+    // rounds to a C float
+    ADDF,
+    SUBF,
+    MULF,
+    DIVF,
+    ROUNDF,
+    POWFI, // powFlt(b, c), c an int
+    POWF,  // (float)pow(b, c)
+
+    // a = b op c as 0 or 1; GT and GE are LT and LE swapped
+    LTI,
+    LEI,
+    EQI,
+    NEI,
+    LTF,
+    LEF,
+    EQF,
+    NEF,
+    EQP, // strings, lists and UDT instances are equal if they are the same one
+    NEP,
+    NOT,
+
+    // jumps to the immediate; the compare and jumps hold it in the next
+    // instruction and jump when b op c
+    JMP,
+    JMPF, // if a is false
+    JMPT, // if a is true
+    JLTI,
+    JLEI,
+    JEQI,
+    JNEI,
+
+    CALL,     // a = functions[b] called with arguments from c
+    CALLB,    // a = builtins[b] called with arguments from c
+    TAILCALL, // return functions[b] called with arguments from c
+    RET,      // return a
+    RETV,     // return nothing
+
+    NEW,      // a = a new instance of udts[b]
+    GETATTR,  // a = b.attributes[c]
+    SETATTR,  // a.attributes[b] = c
+    DELETE,   // hand instance a back to its UDT's pool
+    LEN,      // a = len(b)
+    GETINDEX, // a = b[c]
+    SETINDEX, // a[b] = c
+};
+
+struct Instruction
+{
+    Op op;
+    uint16_t a;
+    uint16_t b;
+    uint16_t c;
+
+    // b and c together, for jump targets and constants
+    int32_t
+    immediate() const
+    {
+        return (int32_t)((uint32_t)b | (uint32_t)c << 16);
+    }
+
+    void
+    setImmediate(int32_t value)
+    {
+        b = (uint16_t)((uint32_t)value & 0xffff);
+        c = (uint16_t)((uint32_t)value >> 16);
+    }
+};
+
+// a register: an int or bool, a flt held as the double of a C float, or a
+// string, list or UDT instance, which are empty when null
+union Value
+{
+    int32_t i;
+    double f;
+    void* p;
+};
+
+struct List
+{
+    std::vector<Value> items;
+};
+
+// a UDT instance is followed by its attributes, in declaration order
+struct Instance
+{
+    size_t udt;
+
+    Value*
+    attributes()
+    {
+        return reinterpret_cast<Value*>(this + 1);
+    }
+};
+
+struct Function
+{
+    std::string name;
+    int parameters; // a method's first parameter is its own instance
+    int registers;
+    std::vector<Instruction> code;
+};
+
+struct UdtLayout
+{
+    std::string name;
+    std::vector<std::pair<std::string, std::string>> attributes; // name, type
+};
+
+struct Program
+{
+    std::vector<Function> functions;
+    std::vector<UdtLayout> udts;
+    std::vector<double> floats;
+    std::deque<std::string> strings;
+    std::vector<std::vector<Value>> lists; // list literals of constants
+    int start = -1;
+};
@@ -0,0 +1,1477 @@
+/*
+ * Robert Durst 2019
+ * Sailfish Programming Language
+ */
+#include "BytecodeCompiler.h"
+#include "Builtins.h"
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <sstream>
+
+namespace
+{
+// C's precedence of each binary operator, or 0 for anything else
+int
+precedence(TokenKind kind)
+{
+    switch (kind)
+    {
+    case TokenKind::ASSIGNMENT:
+    case TokenKind::ADDTO:
+    case TokenKind::SUBFROM:
+    case TokenKind::MULTTO:
+    case TokenKind::DIVFROM:
+        return 1;
+    case TokenKind::OR:
+        return 2;
+    case TokenKind::AND:
+        return 3;
+    case TokenKind::EQUIVALENCE:
+    case TokenKind::NONEQUIVALENCE:
+        return 4;
+    case TokenKind::LESS_THAN:
+    case TokenKind::LESS_THAN_OR_EQUALS:
+    case TokenKind::GREATER_THAN:
+    case TokenKind::GREATER_THAN_OR_EQUALS:
+        return 5;
+    case TokenKind::ADDITION:
+    case TokenKind::SUBTRACTION:
+        return 6;
+    case TokenKind::MULTIPLICATION:
+    case TokenKind::DIVISION:
+    case TokenKind::MODULO:
+        return 7;
+    default:
+        return 0;
+    }
+}
+
+// whether the instruction writes its a register
+bool
+writesA(Op op)
+{
+    switch (op)
+    {
+    case Op::JMP:
+    case Op::JMPF:
+    case Op::JMPT:
+    case Op::JLTI:
+    case Op::JLEI:
+    case Op::JEQI:
+    case Op::JNEI:
+    case Op::TAILCALL:
+    case Op::RET:
+    case Op::RETV:
+    case Op::SETATTR:
+    case Op::DELETE:
+    case Op::SETINDEX:
+        return false;
+    default:
+        return true;
+    }
+}
+
+bool
+isFused(Op op)
+{
+    return op == Op::JLTI || op == Op::JLEI || op == Op::JEQI ||
+           op == Op::JNEI;
+}
+
+bool
+isFloat(const std::string& type)
+{
+    return type == "flt" || type == "dbl";
+}
+
+bool
+isInteger(const std::string& type)
+{
+    return type == "int" || type == "bool";
+}
+
+// the inputs and output of a SymbolTable signature such as F(_[int]_int)int
+void
+parseBuiltinSignature(const std::string& signature,
+                      std::vector<std::string>& parameters,
+                      std::string& output)
+{
+    auto close = signature.find(')');
+    std::stringstream inputs(signature.substr(2, close - 2));
+    std::string input;
+    while (std::getline(inputs, input, '_'))
+        if (input != "" && input != "void")
+            parameters.push_back(input);
+    output = signature.substr(close + 1);
+}
+
+// the characters of a C string literal's body
+std::string
+unescape(const std::string& s)
+{
+    std::string text;
+    for (size_t i = 0; i < s.size(); ++i)
+    {
+        if (s[i] != '\\' || i + 1 == s.size())
+        {
+            text += s[i];
+            continue;
+        }
+
+        auto c = s[++i];
+        switch (c)
+        {
+        case 'n':
+            text += '\n';
+            break;
+        case 't':
+            text += '\t';
+            break;
+        case 'r':
+            text += '\r';
+            break;
+        case 'a':
+            text += '\a';
+            break;
+        case 'b':
+            text += '\b';
+            break;
+        case 'f':
+            text += '\f';
+            break;
+        case 'v':
+            text += '\v';
+            break;
+        case 'x':
+        {
+            int value = 0;
+            while (i + 1 < s.size() && isxdigit(s[i + 1]))
+                value = value * 16 + std::stoi(std::string(1, s[++i]), 0, 16);
+            text += (char)value;
+            break;
+        }
+        default:
+            if (c >= '0' && c <= '7')
+            {
+                int value = c - '0';
+                for (int n = 1; n < 3 && i + 1 < s.size() && s[i + 1] >= '0' &&
+                                s[i + 1] <= '7';
+                     ++n)
+                    value = value * 8 + (s[++i] - '0');
+                text += (char)value;
+            }
+            else
+                text += c;
+        }
+    }
+    return text;
+}
+} // namespace
+
+BytecodeCompiler::BytecodeCompiler()
+    : position(0), current(-1), top(0), localTop(0), label(0)
+{
+    auto& all = getBuiltins();
+    for (size_t i = 0; i < all.size(); ++i)
+    {
+        Signature signature;
+        signature.function = (int)i;
+        parseBuiltinSignature(all[i].signature, signature.parameters,
+                              signature.output);
+        builtins[all[i].name] = signature;
+    }
+}
+
+Program
+BytecodeCompiler::compile(const std::string& file)
+{
+    lex(file);
+    if (at(TokenKind::UAT))
+        unsupported("a UDT file, which has nothing to start");
+
+    while (at(TokenKind::IMPORT))
+        compileImport();
+
+    // functions may call those defined after them
+    declareFunctions(functions, false);
+    while (!at(TokenKind::START))
+        compileFunction(functions);
+    compileStart();
+
+    return std::move(program);
+}
+
+// -------- tokens -------- //
+
+void
+BytecodeCompiler::lex(const std::string& file)
+{
+    filename = file;
+    tokens.clear();
+    position = 0;
+
+    Lexar lexar(file, true);
+    for (;;)
+    {
+        auto token = lexar.getNextToken();
+        if (token->kind == TokenKind::ERROR)
+            throw file + ":" + std::to_string(token->line) + ": " +
+                token->value + "\n";
+
+        // commas are whitespace to sailfishc
+        if (token->kind == TokenKind::COMMENT ||
+            token->kind == TokenKind::COMMA)
+            continue;
+
+        tokens.push_back(*token);
+        if (token->kind == TokenKind::EOF_)
+            return;
+    }
+}
+
+const Token&
+BytecodeCompiler::peek(size_t ahead)
+{
+    return tokens[std::min(position + ahead, tokens.size() - 1)];
+}
+
+bool
+BytecodeCompiler::at(TokenKind kind)
+{
+    return peek().kind == kind;
+}
+
+Token
+BytecodeCompiler::next()
+{
+    auto token = peek();
+    if (position + 1 < tokens.size())
+        ++position;
+    return token;
+}
+
+Token
+BytecodeCompiler::expect(TokenKind kind)
+{
+    if (!at(kind))
+        unsupported("a " + displayKind(peek().kind) + " where a " +
+                    displayKind(kind) + " belongs");
+    return next();
+}
+
+void
+BytecodeCompiler::unsupported(const std::string& what)
+{
+    throw filename + ":" + std::to_string(peek().line) +
+        ": --run cannot lower " + what + ".\n";
+}
+
+// -------- instructions and registers -------- //
+
+std::vector<Instruction>&
+BytecodeCompiler::code()
+{
+    return program.functions[current].code;
+}
+
+size_t
+BytecodeCompiler::emit(Op op, int a, int b, int c)
+{
+    code().push_back(Instruction{op, (uint16_t)a, (uint16_t)b, (uint16_t)c});
+    return code().size() - 1;
+}
+
+size_t
+BytecodeCompiler::emitImmediate(Op op, int a, int32_t immediate)
+{
+    Instruction in{op, (uint16_t)a, 0, 0};
+    in.setImmediate(immediate);
+    code().push_back(in);
+    return code().size() - 1;
+}
+
+void
+BytecodeCompiler::patch(size_t jump)
+{
+    label = code().size();
+    code()[jump].setImmediate((int32_t)label);
+}
+
+int
+BytecodeCompiler::temp()
+{
+    auto reg = top++;
+    if (top > UINT16_MAX)
+        unsupported("a function needing more than 65535 registers");
+
+    auto& function = program.functions[current];
+    function.registers = std::max(function.registers, top);
+    return reg;
+}
+
+bool
+BytecodeCompiler::isTemp(int reg)
+{
+    return reg >= localTop;
+}
+
+// a temporary just written by the last instruction can be written to its
+// destination directly, unless a jump lands after it
+bool
+BytecodeCompiler::canRetarget(int reg)
+{
+    return !code().empty() && label != code().size() && isTemp(reg) &&
+           writesA(code().back().op) && code().back().a == reg;
+}
+
+void
+BytecodeCompiler::moveTo(int dest, int src)
+{
+    if (dest == src)
+        return;
+    if (canRetarget(src))
+        code().back().a = (uint16_t)dest;
+    else
+        emit(Op::MOVE, dest, src);
+}
+
+int
+BytecodeCompiler::load(Operand& operand)
+{
+    if (operand.reg != -1)
+        return operand.reg;
+
+    auto reg = temp();
+    if (operand.isConstant)
+        emitImmediate(Op::LOADI, reg, operand.constant);
+    else if (operand.literal != "")
+    {
+        program.floats.push_back(std::stod(operand.literal));
+        emitImmediate(Op::LOADF, reg, (int32_t)program.floats.size() - 1);
+    }
+    else if (operand.object != -1)
+        emit(Op::GETATTR, reg, operand.object, operand.attribute);
+    else
+        unsupported("the use of a void value");
+
+    operand.reg = reg;
+    return reg;
+}
+
+// the operand's register once converted as C converts a value stored to a
+// variable of the type: a double is rounded to a flt
+int
+BytecodeCompiler::value(Operand& operand, const std::string& type)
+{
+    auto reg = load(operand);
+    if (type != "flt" || operand.type != "dbl")
+        return reg;
+
+    if (!isTemp(reg))
+    {
+        auto rounded = temp();
+        emit(Op::ROUNDF, rounded, reg);
+        return rounded;
+    }
+    emit(Op::ROUNDF, reg, reg);
+    return reg;
+}
+
+// -------- declarations -------- //
+
+std::string
+BytecodeCompiler::resolve(const std::string& type)
+{
+    return type == "own" ? udt : type;
+}
+
+std::string
+BytecodeCompiler::parseType()
+{
+    if (at(TokenKind::LISTTYPE))
+        return next().value;
+    return expect(TokenKind::IDENTIFIER).value;
+}
+
+// reads '(' Variable* ')' '(' Type ')', adding an empty function to be
+// lowered later
+BytecodeCompiler::Signature
+BytecodeCompiler::parseSignature(const std::string& name, bool isMethod)
+{
+    Signature signature;
+    signature.function = (int)program.functions.size();
+
+    expect(TokenKind::LPAREN);
+    while (!at(TokenKind::RPAREN))
+    {
+        auto type = parseType();
+        if (type == "void")
+            continue;
+        expect(TokenKind::IDENTIFIER);
+        signature.parameters.push_back(resolve(type));
+    }
+    expect(TokenKind::RPAREN);
+
+    expect(TokenKind::LPAREN);
+    signature.output = resolve(parseType());
+    expect(TokenKind::RPAREN);
+
+    Function function;
+    function.name = isMethod ? udt + "..." + name : name;
+    function.parameters = (int)signature.parameters.size() + (isMethod ? 1 : 0);
+    function.registers = function.parameters;
+    program.functions.push_back(function);
+
+    return signature;
+}
+
+// reads the signature of every function definition from here on, leaving the
+// position where it was
+void
+BytecodeCompiler::declareFunctions(std::map<std::string, Signature>& into,
+                                   bool isMethod)
+{
+    auto start = position;
+    while (at(TokenKind::LPAREN) && peek(1).kind == TokenKind::FUN)
+    {
+        next();
+        next();
+        auto name = expect(TokenKind::IDENTIFIER).value;
+        into[name] = parseSignature(name, isMethod);
+
+        // skip the body and the definition's closing paren
+        int depth = 1;
+        while (depth > 0)
+        {
+            if (at(TokenKind::EOF_))
+                unsupported("a function without its closing paren");
+            auto kind = next().kind;
+            if (kind == TokenKind::LPAREN)
+                ++depth;
+            else if (kind == TokenKind::RPAREN)
+                --depth;
+        }
+    }
+    position = start;
+}
+
+void
+BytecodeCompiler::compileImport()
+{
+    expect(TokenKind::IMPORT);
+    auto name = expect(TokenKind::IDENTIFIER).value;
+    expect(TokenKind::COLON);
+    auto location = expect(TokenKind::STRING).value;
+
+    if (udts.count(name) == 0)
+        compileUdt(location.substr(1, location.size() - 2), name);
+}
+
+void
+BytecodeCompiler::compileUdt(const std::string& file, const std::string& name)
+{
+    auto importer = std::move(tokens);
+    auto importerPosition = position;
+    auto importerFilename = filename;
+
+    lex(file);
+    udt = name;
+
+    auto& info = udts[name];
+    info.index = program.udts.size();
+
+    UdtLayout layout;
+    layout.name = name;
+    expect(TokenKind::UAT);
+    expect(TokenKind::LCURLEY);
+    while (!at(TokenKind::RCURLEY))
+    {
+        auto type = resolve(parseType());
+        auto attribute = expect(TokenKind::IDENTIFIER).value;
+        layout.attributes.push_back(std::make_pair(attribute, type));
+    }
+    expect(TokenKind::RCURLEY);
+    program.udts.push_back(layout);
+
+    expect(TokenKind::UFN);
+    expect(TokenKind::LCURLEY);
+    declareFunctions(info.methods, true);
+    while (!at(TokenKind::RCURLEY))
+        compileFunction(info.methods);
+    expect(TokenKind::RCURLEY);
+
+    udt = "";
+    tokens = std::move(importer);
+    position = importerPosition;
+    filename = importerFilename;
+}
+
+// FunctionDefinition := '(' 'fun' Identifier FunctionInOut Block ')', the
+// parameters taking the first registers after a method's own instance
+void
+BytecodeCompiler::compileFunction(
+    const std::map<std::string, Signature>& declared)
+{
+    expect(TokenKind::LPAREN);
+    expect(TokenKind::FUN);
+    auto name = expect(TokenKind::IDENTIFIER).value;
+    auto& signature = declared.at(name);
+    beginFunction(signature.function, signature.output);
+
+    int reg = udt != "" ? 1 : 0;
+    expect(TokenKind::LPAREN);
+    while (!at(TokenKind::RPAREN))
+    {
+        auto type = parseType();
+        if (type == "void")
+            continue;
+        auto parameter = expect(TokenKind::IDENTIFIER).value;
+        scopes.back()[parameter] = std::make_pair(reg++, resolve(type));
+    }
+    expect(TokenKind::RPAREN);
+    expect(TokenKind::LPAREN);
+    parseType();
+    expect(TokenKind::RPAREN);
+
+    top = reg;
+    localTop = reg;
+    compileBlock();
+    expect(TokenKind::RPAREN);
+    endFunction();
+}
+
+void
+BytecodeCompiler::compileStart()
+{
+    expect(TokenKind::START);
+
+    Function start;
+    start.name = "start";
+    start.parameters = 0;
+    start.registers = 0;
+    program.functions.push_back(start);
+    program.start = (int)program.functions.size() - 1;
+
+    beginFunction(program.start, "void");
+    compileBlock();
+    endFunction();
+}
+
+void
+BytecodeCompiler::beginFunction(int function, const std::string& out)
+{
+    current = function;
+    output = out;
+    scopes.assign(1, {});
+    top = 0;
+    localTop = 0;
+    label = 0;
+}
+
+void
+BytecodeCompiler::endFunction()
+{
+    if (!endsFlow())
+        emit(Op::RETV);
+
+    // a call followed by returning nothing is in tail position too, such as a
+    // void function's last statement
+    auto& instructions = code();
+    for (size_t i = 0; i < instructions.size(); ++i)
+    {
+        if (instructions[i].op != Op::CALL)
+            continue;
+
+        auto after = i + 1;
+        for (int hops = 0; hops < 8 && instructions[after].op == Op::JMP;
+             ++hops)
+            after = instructions[after].immediate();
+        if (instructions[after].op == Op::RETV)
+            instructions[i].op = Op::TAILCALL;
+    }
+}
+
+// -------- statements -------- //
+
+// Block := '{' Statement* '}'
+void
+BytecodeCompiler::compileBlock()
+{
+    expect(TokenKind::LCURLEY);
+    scopes.emplace_back();
+    auto mark = top;
+
+    while (!at(TokenKind::RCURLEY))
+    {
+        if (at(TokenKind::EOF_))
+            unsupported("a block without its closing curly brace");
+        compileStatement();
+    }
+
+    scopes.pop_back();
+    top = mark;
+    localTop = mark;
+    expect(TokenKind::RCURLEY);
+}
+
+// Statement := Tree | Return | Declaration | Delete | E0, the temporaries of
+// each freed after it
+void
+BytecodeCompiler::compileStatement()
+{
+    auto mark = top;
+    localTop = top;
+
+    switch (peek().kind)
+    {
+    case TokenKind::TREE:
+        compileTree();
+        break;
+    case TokenKind::RETURN:
+        compileReturn();
+        break;
+    case TokenKind::DEC:
+        // keeps the register of the declared local
+        compileDeclaration();
+        return;
+    case TokenKind::DELETE:
+    {
+        next();
+        auto instance = variable(expect(TokenKind::IDENTIFIER).value);
+        emit(Op::DELETE, instance.reg);
+        break;
+    }
+    default:
+        expression(0);
+    }
+
+    top = mark;
+    localTop = mark;
+}
+
+// Tree := 'Tree' '(' ('(' '|' E0 '|' Block ')')* ')', each guard jumping to
+// the next when false and each block to the end of the Tree
+void
+BytecodeCompiler::compileTree()
+{
+    expect(TokenKind::TREE);
+    expect(TokenKind::LPAREN);
+
+    auto mark = top;
+    std::vector<size_t> ends;
+    std::vector<size_t> skips;
+    while (!at(TokenKind::RPAREN))
+    {
+        for (auto jump : skips)
+            patch(jump);
+
+        expect(TokenKind::LPAREN);
+        expect(TokenKind::PIPE);
+        auto guard = expression(0);
+        skips = jumpIfFalse(guard);
+        top = mark;
+        localTop = mark;
+        expect(TokenKind::PIPE);
+
+        compileBlock();
+        expect(TokenKind::RPAREN);
+
+        if (!endsFlow())
+            ends.push_back(emitImmediate(Op::JMP, 0, 0));
+    }
+    expect(TokenKind::RPAREN);
+
+    // the last block can fall through to what follows
+    if (!ends.empty() && ends.back() == code().size() - 1)
+    {
+        code().pop_back();
+        ends.pop_back();
+    }
+    for (auto jump : skips)
+        patch(jump);
+    for (auto jump : ends)
+        patch(jump);
+}
+
+// jumps taken when the guard is false, fusing an int comparison or a not
+// into the jump
+std::vector<size_t>
+BytecodeCompiler::jumpIfFalse(Operand& guard)
+{
+    if (guard.isConstant)
+    {
+        if (guard.constant != 0)
+            return {};
+        return {emitImmediate(Op::JMP, 0, 0)};
+    }
+
+    if (guard.reg != -1 && canRetarget(guard.reg))
+    {
+        auto last = code().back();
+        switch (last.op)
+        {
+        case Op::LTI:
+            code().back() = Instruction{Op::JLEI, 0, last.c, last.b};
+            return {emitImmediate(Op::JMP, 0, 0)};
+        case Op::LEI:
+            code().back() = Instruction{Op::JLTI, 0, last.c, last.b};
+            return {emitImmediate(Op::JMP, 0, 0)};
+        case Op::EQI:
+            code().back() = Instruction{Op::JNEI, 0, last.b, last.c};
+            return {emitImmediate(Op::JMP, 0, 0)};
+        case Op::NEI:
+            code().back() = Instruction{Op::JEQI, 0, last.b, last.c};
+            return {emitImmediate(Op::JMP, 0, 0)};
+        case Op::NOT:
+            code().back() = Instruction{Op::JMPT, last.b, 0, 0};
+            return {code().size() - 1};
+        default:
+            break;
+        }
+    }
+
+    return {emitImmediate(Op::JMPF, load(guard), 0)};
+}
+
+// whether the last instruction never falls through to the next one
+bool
+BytecodeCompiler::endsFlow()
+{
+    auto& instructions = code();
+    if (instructions.empty() || label == instructions.size())
+        return false;
+
+    // the target held after a fused compare and jump is not a jump itself
+    auto size = instructions.size();
+    if (size >= 2 && isFused(instructions[size - 2].op))
+        return false;
+
+    auto op = instructions.back().op;
+    return op == Op::RET || op == Op::RETV || op == Op::TAILCALL ||
+           op == Op::JMP;
+}
+
+// Return := 'return' E0, a returned call becoming a tail call
+void
+BytecodeCompiler::compileReturn()
+{
+    expect(TokenKind::RETURN);
+    auto result = expression(0);
+
+    if (result.reg != -1 && canRetarget(result.reg) &&
+        code().back().op == Op::CALL)
+    {
+        code().back().op = Op::TAILCALL;
+        return;
+    }
+
+    emit(Op::RET, value(result, output));
+}
+
+// Declaration := 'dec' Variable '=' E0, the local taking the first register
+// free after the statement
+void
+BytecodeCompiler::compileDeclaration()
+{
+    expect(TokenKind::DEC);
+    auto type = resolve(parseType());
+    auto name = expect(TokenKind::IDENTIFIER).value;
+    expect(TokenKind::ASSIGNMENT);
+
+    auto mark = top;
+    auto initial = expression(0);
+    auto reg = value(initial, type);
+
+    top = mark;
+    auto local = temp();
+    moveTo(local, reg);
+    localTop = top;
+    scopes.back()[name] = std::make_pair(local, type);
+}
+
+// -------- expressions -------- //
+
+// precedence climbing over C's binary operators; the result of each
+// operator goes to the first register free when its left operand began
+BytecodeCompiler::Operand
+BytecodeCompiler::expression(int minimum)
+{
+    auto start = top;
+    auto left = unary();
+
+    for (;;)
+    {
+        auto kind = peek().kind;
+        auto p = precedence(kind);
+        if (p == 0 || p < minimum)
+            return left;
+        next();
+
+        // assignments group to the right
+        if (p == 1)
+        {
+            auto right = expression(1);
+            left = assign(kind, left, right);
+            continue;
+        }
+
+        if (kind == TokenKind::AND || kind == TokenKind::OR)
+        {
+            auto reg = load(left);
+            top = start;
+            auto result = temp();
+            moveTo(result, reg);
+            auto jump = emitImmediate(
+                kind == TokenKind::AND ? Op::JMPF : Op::JMPT, result, 0);
+
+            auto right = expression(p + 1);
+            moveTo(result, load(right));
+            top = result + 1;
+            patch(jump);
+            left = held(result, "bool");
+            continue;
+        }
+
+        // an attribute is read before the right operand runs
+        if (left.object != -1)
+            load(left);
+        auto right = expression(p + 1);
+        left = binary(kind, left, right, start);
+    }
+}
+
+BytecodeCompiler::Operand
+BytecodeCompiler::unary()
+{
+    switch (peek().kind)
+    {
+    case TokenKind::NEGATION:
+    {
+        next();
+        auto start = top;
+        auto operand = unary();
+        auto reg = load(operand);
+        top = start;
+        auto result = temp();
+        emit(Op::NOT, result, reg);
+        return held(result, "bool");
+    }
+    case TokenKind::UNARYADD:
+    {
+        next();
+        auto operand = unary();
+        return increment(operand, 1);
+    }
+    case TokenKind::UNARYMINUS:
+    {
+        next();
+        auto operand = unary();
+        return increment(operand, -1);
+    }
+    case TokenKind::NEW:
+        return newInstance();
+    default:
+        return postfix(primary());
+    }
+}
+
+// attribute and method access, and ** raising the operand to the single
+// operand after it, which takes any ** of its own so that ** groups right
+BytecodeCompiler::Operand
+BytecodeCompiler::postfix(Operand operand)
+{
+    for (;;)
+    {
+        switch (peek().kind)
+        {
+        case TokenKind::DOT:
+            next();
+            operand = attribute(operand, expect(TokenKind::IDENTIFIER).value);
+            break;
+        case TokenKind::TRIPLE_DOT:
+            next();
+            operand = methodCall(operand, expect(TokenKind::IDENTIFIER).value);
+            break;
+        case TokenKind::EXPONENTIATION:
+        {
+            next();
+            if (operand.object != -1)
+                load(operand);
+            auto exponent = unary();
+            return power(operand, exponent);
+        }
+        default:
+            return operand;
+        }
+    }
+}
+
+// Primary := Bool | Integer | Float | String | own | empty | List |
+// Identifier | FunctionCall | '(' E0 ')'
+BytecodeCompiler::Operand
+BytecodeCompiler::primary()
+{
+    auto token = peek();
+    switch (token.kind)
+    {
+    case TokenKind::LPAREN:
+    {
+        next();
+        auto inner = expression(0);
+        expect(TokenKind::RPAREN);
+        return inner;
+    }
+    case TokenKind::INTEGER:
+        next();
+        return constant((int32_t)(uint32_t)std::stoull(token.value), "int");
+    case TokenKind::BOOL:
+        next();
+        return constant(token.value == "true" ? 1 : 0, "bool");
+    case TokenKind::FLOAT:
+    {
+        next();
+        Operand literal;
+        literal.type = "dbl";
+        literal.literal = token.value;
+        return literal;
+    }
+    case TokenKind::STRING:
+    {
+        next();
+        auto reg = temp();
+        emitImmediate(Op::LOADS, reg,
+                      intern(token.value.substr(1, token.value.size() - 2)));
+        return held(reg, "str");
+    }
+    case TokenKind::OWN_ACCESSOR:
+    {
+        if (udt == "")
+            unsupported("own outside of a UDT");
+        next();
+        auto own = held(0, udt);
+        own.isVariable = true;
+        return own;
+    }
+    case TokenKind::EMPTY:
+    {
+        next();
+        auto reg = temp();
+        emit(Op::LOADNULL, reg);
+        return held(reg, "empty");
+    }
+    case TokenKind::LIST:
+        next();
+        return list(token.value);
+    case TokenKind::IDENTIFIER:
+        next();
+        if (at(TokenKind::LPAREN))
+            return call(token.value);
+        return variable(token.value);
+    default:
+        unsupported("the expression starting with '" + token.value + "'");
+    }
+}
+
+BytecodeCompiler::Operand
+BytecodeCompiler::binary(TokenKind kind, Operand& left, Operand& right,
+                         int start)
+{
+    auto floating = isFloat(left.type) || isFloat(right.type);
+
+    if (kind == TokenKind::EQUIVALENCE || kind == TokenKind::NONEQUIVALENCE)
+    {
+        auto isEqual = kind == TokenKind::EQUIVALENCE;
+        auto op = isEqual ? Op::EQP : Op::NEP;
+        if (floating)
+            op = isEqual ? Op::EQF : Op::NEF;
+        else if (isInteger(left.type) || isInteger(right.type))
+            op = isEqual ? Op::EQI : Op::NEI;
+
+        auto l = load(left);
+        auto r = load(right);
+        top = start;
+        auto result = temp();
+        emit(op, result, l, r);
+        return held(result, "bool");
+    }
+
+    if (precedence(kind) == 5)
+    {
+        auto isStrict = kind == TokenKind::LESS_THAN ||
+                        kind == TokenKind::GREATER_THAN;
+        auto op = floating ? (isStrict ? Op::LTF : Op::LEF)
+                           : (isStrict ? Op::LTI : Op::LEI);
+
+        // a > b is b < a
+        auto l = load(left);
+        auto r = load(right);
+        if (kind == TokenKind::GREATER_THAN ||
+            kind == TokenKind::GREATER_THAN_OR_EQUALS)
+            std::swap(l, r);
+        top = start;
+        auto result = temp();
+        emit(op, result, l, r);
+        return held(result, "bool");
+    }
+
+    if (!floating)
+    {
+        auto isAdd = kind == TokenKind::ADDITION;
+        auto isSubtract = kind == TokenKind::SUBTRACTION;
+        if (left.isConstant && right.isConstant &&
+            (isAdd || isSubtract || kind == TokenKind::MULTIPLICATION))
+        {
+            auto l = (uint32_t)left.constant;
+            auto r = (uint32_t)right.constant;
+            return constant(
+                (int32_t)(isAdd ? l + r : isSubtract ? l - r : l * r), "int");
+        }
+
+        if ((isAdd || isSubtract) && right.isConstant)
+        {
+            auto k = isAdd ? (int64_t)right.constant : -(int64_t)right.constant;
+            if (k >= INT16_MIN && k <= INT16_MAX)
+            {
+                auto l = load(left);
+                top = start;
+                auto result = temp();
+                emit(Op::ADDIK, result, l, (uint16_t)(int16_t)k);
+                return held(result, "int");
+            }
+        }
+
+        Op op;
+        switch (kind)
+        {
+        case TokenKind::ADDITION:
+            op = Op::ADDI;
+            break;
+        case TokenKind::SUBTRACTION:
+            op = Op::SUBI;
+            break;
+        case TokenKind::MULTIPLICATION:
+            op = Op::MULI;
+            break;
+        case TokenKind::DIVISION:
+            op = Op::DIVI;
+            break;
+        default:
+            op = Op::MODI;
+        }
+
+        auto l = load(left);
+        auto r = load(right);
+        top = start;
+        auto result = temp();
+        emit(op, result, l, r);
+        return held(result, "int");
+    }
+
+    Op op;
+    switch (kind)
+    {
+    case TokenKind::ADDITION:
+        op = Op::ADDF;
+        break;
+    case TokenKind::SUBTRACTION:
+        op = Op::SUBF;
+        break;
+    case TokenKind::MULTIPLICATION:
+        op = Op::MULF;
+        break;
+    case TokenKind::DIVISION:
+        op = Op::DIVF;
+        break;
+    default:
+        unsupported("% of flts");
+    }
+
+    auto l = load(left);
+    auto r = load(right);
+    top = start;
+    auto result = temp();
+    emit(op, result, l, r);
+
+    // C computes with two floats in float, and in double with a literal
+    if (left.type == "flt" && right.type == "flt")
+    {
+        emit(Op::ROUNDF, result, result);
+        return held(result, "flt");
+    }
+    return held(result, "dbl");
+}
+
+BytecodeCompiler::Operand
+BytecodeCompiler::assign(TokenKind kind, Operand& target, Operand& right)
+{
+    if (!target.isVariable && target.object == -1)
+        unsupported("an assignment to something not a variable or attribute");
+
+    auto assigned = right;
+    if (kind != TokenKind::ASSIGNMENT)
+    {
+        auto op = kind == TokenKind::ADDTO     ? TokenKind::ADDITION
+                  : kind == TokenKind::SUBFROM ? TokenKind::SUBTRACTION
+                  : kind == TokenKind::MULTTO  ? TokenKind::MULTIPLICATION
+                                               : TokenKind::DIVISION;
+
+        // the target's register or instance stays live below the result
+        auto current = target;
+        assigned = binary(op, current, right, top);
+    }
+
+    auto reg = value(assigned, target.type);
+    if (target.isVariable)
+    {
+        moveTo(target.reg, reg);
+        return target;
+    }
+
+    emit(Op::SETATTR, target.object, target.attribute, reg);
+    auto stored = held(reg, target.type);
+    return stored;
+}
+
+// ++ and --, as += 1 and -= 1
+BytecodeCompiler::Operand
+BytecodeCompiler::increment(Operand& target, int delta)
+{
+    Operand one = constant(1, "int");
+    if (isFloat(target.type))
+    {
+        one = Operand();
+        one.type = "dbl";
+        one.literal = "1.0";
+    }
+    return assign(delta > 0 ? TokenKind::ADDTO : TokenKind::SUBFROM, target,
+                  one);
+}
+
+// ints by powInt, flts by powFlt when the exponent is an integral literal,
+// as sailfishc writes them, and otherwise by pow
+BytecodeCompiler::Operand
+BytecodeCompiler::power(Operand& base, Operand& exponent)
+{
+    if (!isFloat(base.type))
+    {
+        auto b = load(base);
+        auto e = load(exponent);
+        auto result = temp();
+        emit(Op::POWI, result, b, e);
+        return held(result, "int");
+    }
+
+    if (exponent.literal != "")
+    {
+        auto e = std::stod(exponent.literal);
+        if (e == std::floor(e) && e < 2147483648.0)
+        {
+            auto b = load(base);
+            auto integral = temp();
+            emitImmediate(Op::LOADI, integral, (int32_t)e);
+            auto result = temp();
+            emit(Op::POWFI, result, b, integral);
+            return held(result, "flt");
+        }
+    }
+
+    auto b = load(base);
+    auto e = load(exponent);
+    auto result = temp();
+    emit(Op::POWF, result, b, e);
+    return held(result, "flt");
+}
+
+BytecodeCompiler::Operand
+BytecodeCompiler::attribute(Operand& instance, const std::string& name)
+{
+    auto type = resolve(instance.type);
+    auto found = udts.find(type);
+    if (found == udts.end())
+        unsupported("the attribute " + name + " of a " + type);
+
+    auto& attributes = program.udts[found->second.index].attributes;
+    for (size_t i = 0; i < attributes.size(); ++i)
+    {
+        if (attributes[i].first != name)
+            continue;
+
+        Operand operand;
+        operand.type = attributes[i].second;
+        operand.object = load(instance);
+        operand.attribute = (int)i;
+        return operand;
+    }
+    unsupported("the missing attribute " + name + " of " + type);
+}
+
+// a call by name: a method of the UDT being lowered, on own, a builtin, or a
+// function
+BytecodeCompiler::Operand
+BytecodeCompiler::call(const std::string& name)
+{
+    if (udt != "")
+    {
+        auto& methods = udts[udt].methods;
+        if (methods.count(name) != 0)
+        {
+            auto own = held(0, udt);
+            own.isVariable = true;
+            return callSignature(methods.at(name), false, &own);
+        }
+    }
+
+    if (builtins.count(name) != 0)
+        return callSignature(builtins.at(name), true, nullptr);
+    if (functions.count(name) != 0)
+        return callSignature(functions.at(name), false, nullptr);
+    unsupported("a call to the unknown function " + name);
+}
+
+BytecodeCompiler::Operand
+BytecodeCompiler::methodCall(Operand& receiver, const std::string& name)
+{
+    auto type = resolve(receiver.type);
+    auto found = udts.find(type);
+    if (found == udts.end() || found->second.methods.count(name) == 0)
+        unsupported("the method " + name + " of a " + type);
+
+    return callSignature(found->second.methods.at(name), false, &receiver);
+}
+
+// FunctionCall := '(' E0* ')', the arguments in consecutive registers after
+// a method's receiver; list indexing and len become instructions
+BytecodeCompiler::Operand
+BytecodeCompiler::callSignature(const Signature& signature, bool isBuiltin,
+                                Operand* receiver)
+{
+    std::string builtin = isBuiltin ? getBuiltins()[signature.function].name
+                                    : std::string();
+    auto isGet = builtin.rfind("getAtIndex", 0) == 0;
+    auto isSet = builtin.rfind("setAtIndex", 0) == 0;
+    auto isLen = builtin == "len";
+    auto isInstruction = isGet || isSet || isLen;
+
+    auto base = top;
+    if (receiver != nullptr)
+    {
+        // a receiver just computed is already where its slot goes
+        if (receiver->reg != -1 && receiver->reg == top - 1 &&
+            !receiver->isVariable && isTemp(receiver->reg))
+            base = receiver->reg;
+        else
+            moveTo(temp(), value(*receiver, receiver->type));
+        top = base + 1;
+    }
+
+    std::vector<int> arguments;
+    size_t index = 0;
+    expect(TokenKind::LPAREN);
+    while (!at(TokenKind::RPAREN))
+    {
+        // void marks a call without arguments
+        if (at(TokenKind::IDENTIFIER) && peek().value == "void")
+        {
+            next();
+            continue;
+        }
+
+        auto type = index < signature.parameters.size()
+                        ? signature.parameters[index]
+                        : std::string();
+        ++index;
+
+        auto slot = top;
+        auto argument = expression(0);
+        auto reg = value(argument, type);
+        if (isInstruction)
+        {
+            arguments.push_back(reg);
+            continue;
+        }
+
+        if (top == slot)
+            temp();
+        moveTo(slot, reg);
+        top = slot + 1;
+    }
+    expect(TokenKind::RPAREN);
+
+    if (isSet)
+    {
+        emit(Op::SETINDEX, arguments[0], arguments[1], arguments[2]);
+        auto list = held(arguments[0], signature.output);
+        list.isVariable = !isTemp(arguments[0]);
+        return list;
+    }
+
+    top = base;
+    auto result = temp();
+    if (isGet)
+        emit(Op::GETINDEX, result, arguments[0], arguments[1]);
+    else if (isLen)
+        emit(Op::LEN, result, arguments[0]);
+    else
+        emit(isBuiltin ? Op::CALLB : Op::CALL, result, signature.function,
+             base);
+    return held(result, signature.output);
+}
+
+// New := 'new' Identifier '{' (Identifier ':' Primary)* '}'
+BytecodeCompiler::Operand
+BytecodeCompiler::newInstance()
+{
+    expect(TokenKind::NEW);
+    auto name = expect(TokenKind::IDENTIFIER).value;
+    auto found = udts.find(name);
+    if (found == udts.end())
+        unsupported("a new instance of the unknown UDT " + name);
+
+    auto& attributes = program.udts[found->second.index].attributes;
+    auto instance = temp();
+    emit(Op::NEW, instance, (int)found->second.index);
+
+    expect(TokenKind::LCURLEY);
+    while (!at(TokenKind::RCURLEY))
+    {
+        auto key = expect(TokenKind::IDENTIFIER).value;
+        expect(TokenKind::COLON);
+
+        size_t i = 0;
+        while (i < attributes.size() && attributes[i].first != key)
+            ++i;
+        if (i == attributes.size())
+            unsupported("the missing attribute " + key + " of " + name);
+
+        auto mark = top;
+        auto item = primary();
+        emit(Op::SETATTR, instance, (int)i, value(item, attributes[i].second));
+        top = mark;
+    }
+    expect(TokenKind::RCURLEY);
+
+    return held(instance, name);
+}
+
+// List := '[' (literal | Identifier)* ']', copied from a constant list with
+// the variables written in after
+BytecodeCompiler::Operand
+BytecodeCompiler::list(const std::string& text)
+{
+    std::vector<Value> items;
+    std::vector<std::pair<int32_t, Operand>> variables;
+    std::string element = "any";
+
+    std::stringstream values(text.substr(1, text.size() - 2));
+    std::string segment;
+    while (std::getline(values, segment, ','))
+    {
+        Lexar lexar(segment + " ", false);
+        auto token = lexar.getNextToken();
+        if (token->kind == TokenKind::EOF_)
+            continue;
+
+        Value item;
+        item.p = nullptr;
+        std::string type;
+        switch (token->kind)
+        {
+        case TokenKind::INTEGER:
+            item.i = (int32_t)(uint32_t)std::stoull(token->value);
+            type = "int";
+            break;
+        case TokenKind::FLOAT:
+            item.f = (float)std::stod(token->value);
+            type = "flt";
+            break;
+        case TokenKind::BOOL:
+            item.i = token->value == "true" ? 1 : 0;
+            type = "bool";
+            break;
+        case TokenKind::STRING:
+            item.p = (void*)program
+                         .strings[intern(token->value.substr(
+                             1, token->value.size() - 2))]
+                         .c_str();
+            type = "str";
+            break;
+        case TokenKind::IDENTIFIER:
+        {
+            auto operand = variable(token->value);
+            type = operand.type;
+            variables.push_back(std::make_pair((int32_t)items.size(), operand));
+            break;
+        }
+        default:
+            unsupported("the list element " + token->value);
+        }
+
+        if (items.empty())
+            element = type;
+        items.push_back(item);
+    }
+
+    program.lists.push_back(items);
+    auto reg = temp();
+    emitImmediate(Op::LOADLIST, reg, (int32_t)program.lists.size() - 1);
+    for (auto& [index, operand] : variables)
+    {
+        auto position = temp();
+        emitImmediate(Op::LOADI, position, index);
+        emit(Op::SETINDEX, reg, position, value(operand, element));
+        top = position;
+    }
+
+    return held(reg, "[" + element + "]");
+}
+
+BytecodeCompiler::Operand
+BytecodeCompiler::variable(const std::string& name)
+{
+    for (auto scope = scopes.rbegin(); scope != scopes.rend(); ++scope)
+    {
+        auto found = scope->find(name);
+        if (found == scope->end())
+            continue;
+
+        auto operand = held(found->second.first, found->second.second);
+        operand.isVariable = true;
+        return operand;
+    }
+    unsupported("the unknown variable " + name);
+}
+
+BytecodeCompiler::Operand
+BytecodeCompiler::constant(int32_t value, const std::string& type)
+{
+    Operand operand;
+    operand.type = type;
+    operand.isConstant = true;
+    operand.constant = value;
+    return operand;
+}
+
+BytecodeCompiler::Operand
+BytecodeCompiler::held(int reg, const std::string& type)
+{
+    Operand operand;
+    operand.type = type;
+    operand.reg = reg;
+    return operand;
+}
+
+// the index of a string literal's text, the same for equal literals as C
+// compilers merge them
+int
+BytecodeCompiler::intern(const std::string& literal)
+{
+    auto text = unescape(literal);
+    auto found = strings.find(text);
+    if (found != strings.end())
+        return found->second;
+
+    program.strings.push_back(text);
+    strings[text] = (int)program.strings.size() - 1;
+    return strings[text];
+}
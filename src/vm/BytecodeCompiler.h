@@ -0,0 +1,141 @@
+/*
+ * Robert Durst 2019
+ * Sailfish Programming Language
+ *
+ * BytecodeCompiler lowers a program sailfishc has already checked to the
+ * bytecode VM runs for --run. Like sailfishc it makes a single pass over the
+ * tokens with no tree in between, so every expression means what the C
+ * sailfishc writes for it means: C's precedence, ** binding tighter than it
+ * and grouping to the right, and flt arithmetic done in float unless a
+ * literal makes it double. Nothing is checked again, so anything the
+ * checker would reject may lower to nonsense.
+ */
+#pragma once
+#include "../lexar/Lexar.h"
+#include "../lexar/Token.h"
+#include "Bytecode.h"
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+class BytecodeCompiler
+{
+  private:
+    // a function, method or builtin as its callers see it
+    struct Signature
+    {
+        int function; // into Program::functions, or the builtins
+        std::vector<std::string> parameters;
+        std::string output;
+    };
+
+    struct Udt
+    {
+        size_t index; // into Program::udts
+        std::map<std::string, Signature> methods;
+    };
+
+    // the value of an expression: in a register, or an int or flt literal
+    // or an attribute not yet loaded into one
+    struct Operand
+    {
+        std::string type; // flt values computed in double are "dbl"
+        int reg = -1;
+        bool isVariable = false; // reg belongs to a local
+        bool isConstant = false;
+        int32_t constant = 0;
+        std::string literal; // a flt literal's text
+        int object = -1;     // the instance holding an attribute
+        int attribute = -1;
+    };
+
+    Program program;
+    std::map<std::string, Signature> builtins;
+    std::map<std::string, Signature> functions;
+    std::map<std::string, Udt> udts;
+    std::map<std::string, int> strings;
+
+    // the file being lowered, and the UDT it defines or ""
+    std::vector<Token> tokens;
+    size_t position;
+    std::string filename;
+    std::string udt;
+
+    // the function being lowered: its return type, its locals by scope, the
+    // next free register, the first register not held by a local, and where
+    // the last jump target was placed
+    int current;
+    std::string output;
+    std::vector<std::map<std::string, std::pair<int, std::string>>> scopes;
+    int top;
+    int localTop;
+    size_t label;
+
+    // tokens
+    void lex(const std::string&);
+    const Token& peek(size_t ahead = 0);
+    bool at(TokenKind);
+    Token next();
+    Token expect(TokenKind);
+    [[noreturn]] void unsupported(const std::string&);
+
+    // instructions and registers
+    std::vector<Instruction>& code();
+    size_t emit(Op, int a = 0, int b = 0, int c = 0);
+    size_t emitImmediate(Op, int a, int32_t);
+    void patch(size_t jump); // to the next instruction
+    int temp();
+    bool isTemp(int);
+    bool canRetarget(int);
+    void moveTo(int, int);
+    int load(Operand&);
+    int value(Operand&, const std::string& type);
+
+    // declarations
+    std::string resolve(const std::string&);
+    std::string parseType();
+    Signature parseSignature(const std::string& name, bool isMethod);
+    void declareFunctions(std::map<std::string, Signature>&, bool isMethod);
+    void compileImport();
+    void compileUdt(const std::string& file, const std::string& name);
+    void compileFunction(const std::map<std::string, Signature>&);
+    void compileStart();
+    void beginFunction(int, const std::string& output);
+    void endFunction();
+
+    // statements
+    void compileBlock();
+    void compileStatement();
+    void compileTree();
+    void compileReturn();
+    void compileDeclaration();
+    std::vector<size_t> jumpIfFalse(Operand&);
+    bool endsFlow();
+
+    // expressions
+    Operand expression(int precedence);
+    Operand unary();
+    Operand postfix(Operand);
+    Operand primary();
+    Operand binary(TokenKind, Operand&, Operand&, int start);
+    Operand assign(TokenKind, Operand&, Operand&);
+    Operand increment(Operand&, int delta);
+    Operand power(Operand&, Operand&);
+    Operand attribute(Operand&, const std::string&);
+    Operand call(const std::string&);
+    Operand methodCall(Operand&, const std::string&);
+    Operand callSignature(const Signature&, bool isBuiltin, Operand* receiver);
+    Operand newInstance();
+    Operand list(const std::string&);
+    Operand variable(const std::string&);
+    Operand constant(int32_t, const std::string& type);
+    Operand held(int reg, const std::string& type);
+    int intern(const std::string&);
+
+  public:
+    BytecodeCompiler();
+
+    // lowers the script in the file and its imports
+    Program compile(const std::string& filename);
+};
@@ -0,0 +1,446 @@
+/*
+ * Robert Durst 2019
+ * Sailfish Programming Language
+ */
+#include "VM.h"
+#include "Builtins.h"
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+// the size of the C runtime's output buffer
+const size_t OUTPUT_BUFFER_SIZE = 65536;
+
+// registers the stack starts with, grown as calls need more
+const size_t INITIAL_STACK = 1 << 16;
+
+Output::Output(bool lb) : lineBuffered(lb)
+{
+    buffer.reserve(OUTPUT_BUFFER_SIZE);
+}
+
+Output::~Output()
+{
+    flush();
+}
+
+void
+Output::writeLine(const char* s, size_t n)
+{
+    auto write = [this](const char* bytes, size_t count) {
+        if (count > OUTPUT_BUFFER_SIZE - buffer.size())
+        {
+            flush();
+            if (count > OUTPUT_BUFFER_SIZE)
+            {
+                fwrite(bytes, 1, count, stdout);
+                return;
+            }
+        }
+        buffer.insert(buffer.end(), bytes, bytes + count);
+    };
+
+    write(s, n);
+    write("\n", 1);
+    if (lineBuffered)
+        flush();
+}
+
+void
+Output::flush()
+{
+    if (buffer.size() > 0)
+        fwrite(buffer.data(), 1, buffer.size(), stdout);
+    buffer.clear();
+    fflush(stdout);
+}
+
+// -------- ints and flts as the C runtime computes them -------- //
+
+namespace
+{
+int32_t
+powInt(int32_t base, int32_t exponent)
+{
+    uint32_t result = 1;
+    uint32_t square = (uint32_t)base;
+
+    if (exponent < 0)
+    {
+        if (base == 1)
+            return 1;
+        if (base == -1)
+            return (exponent & 1) ? -1 : 1;
+        return 0;
+    }
+
+    while (exponent > 0)
+    {
+        if (exponent & 1)
+            result *= square;
+        square *= square;
+        exponent >>= 1;
+    }
+
+    return (int32_t)result;
+}
+
+float
+powFlt(float base, int32_t exponent)
+{
+    double result = 1.0;
+    double square = base;
+    uint32_t n = exponent < 0 ? 0u - (uint32_t)exponent : (uint32_t)exponent;
+
+    while (n > 0)
+    {
+        if (n & 1)
+            result *= square;
+        square *= square;
+        n >>= 1;
+    }
+
+    return (float)(exponent < 0 ? 1.0 / result : result);
+}
+
+int32_t
+wrap(uint32_t i)
+{
+    return (int32_t)i;
+}
+} // namespace
+
+// -------- the VM -------- //
+
+VM::VM(const Program& p, bool lineBuffered)
+    : program(p), output(lineBuffered), pools(p.udts.size())
+{
+    stack.resize(INITIAL_STACK);
+}
+
+VM::~VM()
+{
+    for (auto instance : instances)
+        free(instance);
+}
+
+void
+VM::reserve(size_t registers)
+{
+    if (registers > stack.size())
+        stack.resize(std::max(registers, stack.size() * 2));
+}
+
+Instance*
+VM::allocate(size_t udt)
+{
+    auto& pool = pools[udt];
+    if (pool.size() > 0)
+    {
+        auto instance = pool.back();
+        pool.pop_back();
+        return instance;
+    }
+
+    auto attributes = program.udts[udt].attributes.size();
+    auto size = sizeof(Instance) + attributes * sizeof(Value);
+    auto instance = static_cast<Instance*>(calloc(1, size));
+    if (instance == nullptr)
+        fail("Out of memory.");
+    instances.push_back(instance);
+    instance->udt = udt;
+    return instance;
+}
+
+List*
+VM::newList()
+{
+    lists.push_back(std::make_unique<List>());
+    return lists.back().get();
+}
+
+void
+VM::fail(const std::string& message)
+{
+    throw RuntimeError{message};
+}
+
+void
+VM::checkIndex(const List* list, int32_t index)
+{
+    auto length = list == nullptr ? 0 : (int32_t)list->items.size();
+    if (index < 0 || index >= length)
+        fail("List index " + std::to_string(index) +
+             " is out of bounds for length " + std::to_string(length) + ".");
+}
+
+int
+VM::run()
+{
+    if (program.start == -1)
+        return 0;
+
+    try
+    {
+        execute();
+    }
+    catch (const RuntimeError& error)
+    {
+        output.flush();
+        std::cerr << error.message << "\n";
+        return 1;
+    }
+
+    output.flush();
+    return 0;
+}
+
+void
+VM::execute()
+{
+    auto& builtins = getBuiltins();
+    auto function = &program.functions[program.start];
+    auto pc = function->code.data();
+    size_t base = 0;
+
+    reserve(function->registers);
+    auto r = stack.data();
+
+    auto instance = [this](const Value& v) {
+        if (v.p == nullptr)
+            fail("Attribute access on empty.");
+        return static_cast<Instance*>(v.p);
+    };
+
+    for (;;)
+    {
+        auto in = *pc++;
+        switch (in.op)
+        {
+        case Op::MOVE:
+            r[in.a] = r[in.b];
+            break;
+        case Op::LOADI:
+            r[in.a].i = in.immediate();
+            break;
+        case Op::LOADF:
+            r[in.a].f = program.floats[in.immediate()];
+            break;
+        case Op::LOADS:
+            r[in.a].p = (void*)program.strings[in.immediate()].c_str();
+            break;
+        case Op::LOADNULL:
+            r[in.a].p = nullptr;
+            break;
+        case Op::LOADLIST:
+        {
+            auto list = newList();
+            list->items = program.lists[in.immediate()];
+            r[in.a].p = list;
+            break;
+        }
+
+        case Op::ADDI:
+            r[in.a].i = wrap((uint32_t)r[in.b].i + (uint32_t)r[in.c].i);
+            break;
+        case Op::SUBI:
+            r[in.a].i = wrap((uint32_t)r[in.b].i - (uint32_t)r[in.c].i);
+            break;
+        case Op::MULI:
+            r[in.a].i = wrap((uint32_t)r[in.b].i * (uint32_t)r[in.c].i);
+            break;
+        case Op::DIVI:
+            if (r[in.c].i == 0)
+                fail("Division by zero.");
+            if (r[in.c].i == -1)
+                r[in.a].i = wrap(0u - (uint32_t)r[in.b].i);
+            else
+                r[in.a].i = r[in.b].i / r[in.c].i;
+            break;
+        case Op::MODI:
+            if (r[in.c].i == 0)
+                fail("Division by zero.");
+            if (r[in.c].i == -1)
+                r[in.a].i = 0;
+            else
+                r[in.a].i = r[in.b].i % r[in.c].i;
+            break;
+        case Op::ADDIK:
+            r[in.a].i = wrap((uint32_t)r[in.b].i + (uint32_t)(int16_t)in.c);
+            break;
+        case Op::POWI:
+            r[in.a].i = powInt(r[in.b].i, r[in.c].i);
+            break;
+
+        case Op::ADDF:
+            r[in.a].f = r[in.b].f + r[in.c].f;
+            break;
+        case Op::SUBF:
+            r[in.a].f = r[in.b].f - r[in.c].f;
+            break;
+        case Op::MULF:
+            r[in.a].f = r[in.b].f * r[in.c].f;
+            break;
+        case Op::DIVF:
+            r[in.a].f = r[in.b].f / r[in.c].f;
+            break;
+        case Op::ROUNDF:
+            r[in.a].f = (float)r[in.b].f;
+            break;
+        case Op::POWFI:
+            r[in.a].f = powFlt((float)r[in.b].f, r[in.c].i);
+            break;
+        case Op::POWF:
+            r[in.a].f = (float)std::pow(r[in.b].f, r[in.c].f);
+            break;
+
+        case Op::LTI:
+            r[in.a].i = r[in.b].i < r[in.c].i;
+            break;
+        case Op::LEI:
+            r[in.a].i = r[in.b].i <= r[in.c].i;
+            break;
+        case Op::EQI:
+            r[in.a].i = r[in.b].i == r[in.c].i;
+            break;
+        case Op::NEI:
+            r[in.a].i = r[in.b].i != r[in.c].i;
+            break;
+        case Op::LTF:
+            r[in.a].i = r[in.b].f < r[in.c].f;
+            break;
+        case Op::LEF:
+            r[in.a].i = r[in.b].f <= r[in.c].f;
+            break;
+        case Op::EQF:
+            r[in.a].i = r[in.b].f == r[in.c].f;
+            break;
+        case Op::NEF:
+            r[in.a].i = r[in.b].f != r[in.c].f;
+            break;
+        case Op::EQP:
+            r[in.a].i = r[in.b].p == r[in.c].p;
+            break;
+        case Op::NEP:
+            r[in.a].i = r[in.b].p != r[in.c].p;
+            break;
+        case Op::NOT:
+            r[in.a].i = !r[in.b].i;
+            break;
+
+        case Op::JMP:
+            pc = function->code.data() + in.immediate();
+            break;
+        case Op::JMPF:
+            if (!r[in.a].i)
+                pc = function->code.data() + in.immediate();
+            break;
+        case Op::JMPT:
+            if (r[in.a].i)
+                pc = function->code.data() + in.immediate();
+            break;
+        case Op::JLTI:
+            if (r[in.b].i < r[in.c].i)
+                pc = function->code.data() + pc->immediate();
+            else
+                ++pc;
+            break;
+        case Op::JLEI:
+            if (r[in.b].i <= r[in.c].i)
+                pc = function->code.data() + pc->immediate();
+            else
+                ++pc;
+            break;
+        case Op::JEQI:
+            if (r[in.b].i == r[in.c].i)
+                pc = function->code.data() + pc->immediate();
+            else
+                ++pc;
+            break;
+        case Op::JNEI:
+            if (r[in.b].i != r[in.c].i)
+                pc = function->code.data() + pc->immediate();
+            else
+                ++pc;
+            break;
+
+        case Op::CALL:
+        {
+            frames.push_back({function, pc, base, in.a});
+            function = &program.functions[in.b];
+            pc = function->code.data();
+            base += in.c;
+            reserve(base + function->registers);
+            r = stack.data() + base;
+            break;
+        }
+        case Op::CALLB:
+            r[in.a] = builtins[in.b].function(*this, r + in.c);
+            break;
+        case Op::TAILCALL:
+        {
+            function = &program.functions[in.b];
+            pc = function->code.data();
+            memmove(r, r + in.c, function->parameters * sizeof(Value));
+            reserve(base + function->registers);
+            r = stack.data() + base;
+            break;
+        }
+        case Op::RET:
+        case Op::RETV:
+        {
+            if (frames.empty())
+                return;
+
+            auto result = r[in.a];
+            auto caller = frames.back();
+            frames.pop_back();
+            function = caller.function;
+            pc = caller.pc;
+            base = caller.base;
+            r = stack.data() + base;
+            if (in.op == Op::RET)
+                r[caller.result] = result;
+            break;
+        }
+
+        case Op::NEW:
+            r[in.a].p = allocate(in.b);
+            break;
+        case Op::GETATTR:
+            r[in.a] = instance(r[in.b])->attributes()[in.c];
+            break;
+        case Op::SETATTR:
+            instance(r[in.a])->attributes()[in.b] = r[in.c];
+            break;
+        case Op::DELETE:
+            if (r[in.a].p != nullptr)
+            {
+                auto released = static_cast<Instance*>(r[in.a].p);
+                pools[released->udt].push_back(released);
+            }
+            break;
+        case Op::LEN:
+        {
+            auto list = static_cast<List*>(r[in.b].p);
+            r[in.a].i = list == nullptr ? 0 : (int32_t)list->items.size();
+            break;
+        }
+        case Op::GETINDEX:
+        {
+            auto list = static_cast<List*>(r[in.b].p);
+            checkIndex(list, r[in.c].i);
+            r[in.a] = list->items[r[in.c].i];
+            break;
+        }
+        case Op::SETINDEX:
+        {
+            auto list = static_cast<List*>(r[in.a].p);
+            checkIndex(list, r[in.b].i);
+            list->items[r[in.b].i] = r[in.c];
+            break;
+        }
+        }
+    }
+}
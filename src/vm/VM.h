@@ -0,0 +1,84 @@
+/*
+ * Robert Durst 2019
+ * Sailfish Programming Language
+ *
+ * VM runs a Program lowered by BytecodeCompiler, in the sailfishc process, for
+ * --run. Frames live on a stack of registers which grows as needed, so deep
+ * recursion is only limited by memory, and calls in tail position reuse their
+ * caller's frame. Printing is buffered like the C runtime's and formats the
+ * same way, and runtime errors are reported as the C runtime reports them,
+ * ending the run with status 1.
+ */
+#pragma once
+#include "Bytecode.h"
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <vector>
+
+// printed output, written to stdout when the buffer fills, after every line
+// when line buffered, and when the run ends
+class Output
+{
+  private:
+    std::vector<char> buffer;
+    bool lineBuffered;
+
+  public:
+    explicit Output(bool lineBuffered);
+    ~Output();
+
+    void writeLine(const char* s, size_t n);
+    void flush();
+};
+
+// thrown by VM::fail and caught by VM::run
+struct RuntimeError
+{
+    std::string message;
+};
+
+class VM
+{
+  private:
+    struct Frame
+    {
+        const Function* function;
+        const Instruction* pc; // where the caller continues
+        size_t base;
+        int result; // the caller's register for the returned value
+    };
+
+    const Program& program;
+    Output output;
+    std::vector<Value> stack;
+    std::vector<Frame> frames;
+
+    // everything allocated, freed when the VM is, and each UDT's instances
+    // handed back by delete
+    std::vector<std::unique_ptr<List>> lists;
+    std::vector<void*> instances;
+    std::vector<std::vector<Instance*>> pools;
+
+    void reserve(size_t);
+    Instance* allocate(size_t udt);
+    void execute();
+
+  public:
+    VM(const Program&, bool lineBuffered);
+    ~VM();
+
+    // runs start, returning 0, or 1 after a runtime error
+    int run();
+
+    List* newList();
+    Output&
+    getOutput()
+    {
+        return output;
+    }
+
+    // ends the run with a runtime error
+    [[noreturn]] void fail(const std::string& message);
+    void checkIndex(const List*, int32_t index);
+};